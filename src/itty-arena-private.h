@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+#include "itty-arena.h"
+
+#define ITTY_ARENA_MINIMUM_CHUNK_SIZE (64 * 1024)
+
+typedef struct itty_arena_chunk_t itty_arena_chunk_t;
+
+struct itty_arena_chunk_t {
+        itty_arena_chunk_t *next;
+        size_t              size;
+        size_t              used;
+        max_align_t         data[];
+};
+
+struct itty_arena_t {
+        itty_arena_chunk_t *chunks;
+        size_t              total_size;
+};
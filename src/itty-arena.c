@@ -0,0 +1,137 @@
+#include "itty-arena.h"
+#include "itty-arena-private.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static _Thread_local itty_arena_t *itty_arena_thread_default = NULL;
+
+itty_arena_t *
+itty_arena_new (void)
+{
+        itty_arena_t *arena = malloc (sizeof (itty_arena_t));
+        arena->chunks = NULL;
+        arena->total_size = 0;
+        return arena;
+}
+
+static void
+itty_arena_free_chunks (itty_arena_t *arena)
+{
+        itty_arena_chunk_t *chunk = arena->chunks;
+
+        while (chunk != NULL) {
+                itty_arena_chunk_t *next = chunk->next;
+                free (chunk);
+                chunk = next;
+        }
+
+        arena->chunks = NULL;
+        arena->total_size = 0;
+}
+
+void
+itty_arena_free (itty_arena_t *arena)
+{
+        if (!arena)
+                return;
+
+        assert (itty_arena_thread_default != arena);
+
+        itty_arena_free_chunks (arena);
+        free (arena);
+}
+
+static itty_arena_chunk_t *
+itty_arena_add_chunk (itty_arena_t *arena,
+                      size_t        size)
+{
+        itty_arena_chunk_t *chunk = malloc (sizeof (itty_arena_chunk_t) + size);
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->total_size += size;
+        return chunk;
+}
+
+void *
+itty_arena_allocate (itty_arena_t *arena,
+                     size_t        size)
+{
+        itty_arena_chunk_t *chunk = arena->chunks;
+
+        size = (size + alignof (max_align_t) - 1) & ~(alignof (max_align_t) - 1);
+
+        if (chunk == NULL || chunk->size - chunk->used < size) {
+                size_t chunk_size = ITTY_ARENA_MINIMUM_CHUNK_SIZE;
+
+                if (chunk != NULL && chunk_size < chunk->size * 2)
+                        chunk_size = chunk->size * 2;
+                if (chunk_size < size)
+                        chunk_size = size;
+
+                chunk = itty_arena_add_chunk (arena, chunk_size);
+        }
+
+        void *memory = (char *) chunk->data + chunk->used;
+        chunk->used += size;
+        return memory;
+}
+
+void *
+itty_arena_allocate_aligned (itty_arena_t *arena,
+                             size_t        size,
+                             size_t        alignment)
+{
+        assert ((alignment & (alignment - 1)) == 0);
+
+        if (alignment <= alignof (max_align_t))
+                return itty_arena_allocate (arena, size);
+
+        uintptr_t memory = (uintptr_t) itty_arena_allocate (arena, size + alignment - alignof (max_align_t));
+
+        return (void *) ((memory + alignment - 1) & ~(uintptr_t) (alignment - 1));
+}
+
+void
+itty_arena_reset (itty_arena_t *arena)
+{
+        if (arena->chunks == NULL)
+                return;
+
+        if (arena->chunks->next != NULL) {
+                size_t total_size = arena->total_size;
+
+                itty_arena_free_chunks (arena);
+                itty_arena_add_chunk (arena, total_size);
+                return;
+        }
+
+        arena->chunks->used = 0;
+}
+
+itty_arena_t *
+itty_arena_push_thread_default (itty_arena_t *arena)
+{
+        itty_arena_t *previous_arena = itty_arena_thread_default;
+
+        itty_arena_thread_default = arena;
+        return previous_arena;
+}
+
+void
+itty_arena_pop_thread_default (itty_arena_t *arena,
+                               itty_arena_t *previous_arena)
+{
+        assert (itty_arena_thread_default == arena);
+
+        itty_arena_thread_default = previous_arena;
+}
+
+itty_arena_t *
+itty_arena_get_thread_default (void)
+{
+        return itty_arena_thread_default;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+
+typedef struct itty_arena_t itty_arena_t;
+
+itty_arena_t *itty_arena_new (void);
+void itty_arena_free (itty_arena_t *arena);
+
+void *itty_arena_allocate (itty_arena_t *arena,
+                           size_t        size);
+void *itty_arena_allocate_aligned (itty_arena_t *arena,
+                                   size_t        size,
+                                   size_t        alignment);
+void itty_arena_reset (itty_arena_t *arena);
+
+itty_arena_t *itty_arena_push_thread_default (itty_arena_t *arena);
+void itty_arena_pop_thread_default (itty_arena_t *arena,
+                                    itty_arena_t *previous_arena);
+itty_arena_t *itty_arena_get_thread_default (void);
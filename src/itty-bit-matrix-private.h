@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "itty-arena.h"
+#include "itty-bit-string.h"
+
+/* Row i starts at word i * number_of_words of storage */
+struct itty_bit_matrix_t {
+        itty_bit_string_t *storage;
+        size_t             number_of_rows;
+        size_t             number_of_words;
+        itty_arena_t      *arena;
+};
@@ -0,0 +1,297 @@
+#include "itty-bit-matrix.h"
+#include "itty-bit-matrix-private.h"
+#include "itty-bit-string-list-private.h"
+#include "itty-bit-string-private.h"
+#include "itty-bit-string-kernels-private.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+itty_bit_matrix_t *
+itty_bit_matrix_new_for_bit_string (itty_bit_string_t *bit_string,
+                                    size_t             number_of_rows,
+                                    size_t             number_of_words)
+{
+        assert (itty_bit_string_get_number_of_words (bit_string) >= number_of_rows * number_of_words);
+
+        itty_arena_t *arena = itty_arena_get_thread_default ();
+        itty_bit_matrix_t *matrix;
+
+        if (arena != NULL)
+                matrix = itty_arena_allocate (arena, sizeof (itty_bit_matrix_t));
+        else
+                matrix = malloc (sizeof (itty_bit_matrix_t));
+
+        itty_bit_string_make_dense (bit_string);
+
+        matrix->arena = arena;
+        matrix->storage = bit_string;
+        matrix->number_of_rows = number_of_rows;
+        matrix->number_of_words = number_of_words;
+        return matrix;
+}
+
+itty_bit_matrix_t *
+itty_bit_matrix_new (size_t number_of_rows,
+                     size_t number_of_words)
+{
+        itty_bit_string_t *storage = itty_bit_string_new_aligned (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+        itty_bit_string_append_zeros (storage, number_of_rows * number_of_words);
+
+        return itty_bit_matrix_new_for_bit_string (storage, number_of_rows, number_of_words);
+}
+
+itty_bit_matrix_t *
+itty_bit_matrix_new_from_list (itty_bit_string_list_t *list)
+{
+        itty_bit_matrix_t *matrix = itty_bit_matrix_new (list->count, list->max_number_of_words);
+
+        for (size_t row = 0; row < list->count; row++)
+                itty_bit_matrix_set_row (matrix, row, list->bit_strings[row]);
+
+        return matrix;
+}
+
+void
+itty_bit_matrix_free (itty_bit_matrix_t *matrix)
+{
+        if (!matrix)
+                return;
+
+        itty_bit_string_unref (matrix->storage);
+
+        if (matrix->arena != NULL)
+                return;
+
+        free (matrix);
+}
+
+size_t
+itty_bit_matrix_get_number_of_rows (itty_bit_matrix_t *matrix)
+{
+        return matrix->number_of_rows;
+}
+
+size_t
+itty_bit_matrix_get_number_of_words (itty_bit_matrix_t *matrix)
+{
+        return matrix->number_of_words;
+}
+
+/* Shared or borrowed storage is copied before the first write, so row views keep their contents */
+static void
+itty_bit_matrix_make_writable (itty_bit_matrix_t *matrix)
+{
+        itty_bit_string_t *storage = matrix->storage;
+
+        if (storage->mutability == ITTY_BIT_STRING_MUTABILITY_READ_WRITE &&
+            atomic_load_explicit (&storage->reference_count, memory_order_relaxed) == 1)
+                return;
+
+        matrix->storage = itty_bit_string_copy (storage);
+        itty_bit_string_unref (storage);
+}
+
+static inline size_t *
+itty_bit_matrix_get_writable_row_words (itty_bit_matrix_t *matrix,
+                                        size_t             row)
+{
+        return matrix->storage->words + row * matrix->number_of_words;
+}
+
+static void
+itty_bit_matrix_invalidate (itty_bit_matrix_t *matrix)
+{
+        matrix->storage->pop_count_computed = false;
+        matrix->storage->bit_length_computed = false;
+        matrix->storage->hash_computed = false;
+}
+
+const size_t *
+itty_bit_matrix_get_row_words (itty_bit_matrix_t *matrix,
+                               size_t             row)
+{
+        assert (row < matrix->number_of_rows);
+
+        return matrix->storage->words + row * matrix->number_of_words;
+}
+
+void
+itty_bit_matrix_set_row (itty_bit_matrix_t *matrix,
+                         size_t             row,
+                         itty_bit_string_t *bit_string)
+{
+        assert (row < matrix->number_of_rows);
+
+        size_t number_of_words = itty_bit_string_get_number_of_words (bit_string);
+
+        if (number_of_words > matrix->number_of_words)
+                number_of_words = matrix->number_of_words;
+
+        itty_bit_matrix_make_writable (matrix);
+
+        size_t *row_words = itty_bit_matrix_get_writable_row_words (matrix, row);
+        itty_bit_string_copy_words (bit_string, row_words, number_of_words);
+        memset (row_words + number_of_words, 0, (matrix->number_of_words - number_of_words) * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+
+        itty_bit_matrix_invalidate (matrix);
+}
+
+itty_bit_string_t *
+itty_bit_matrix_get_row (itty_bit_matrix_t *matrix,
+                         size_t             row)
+{
+        assert (row < matrix->number_of_rows);
+
+        return itty_bit_string_new_view (matrix->storage, row * matrix->number_of_words, matrix->number_of_words);
+}
+
+itty_bit_string_list_t *
+itty_bit_matrix_get_rows (itty_bit_matrix_t *matrix)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+
+        for (size_t row = 0; row < matrix->number_of_rows; row++)
+                itty_bit_string_list_append (list, itty_bit_matrix_get_row (matrix, row));
+
+        return list;
+}
+
+static const itty_bit_string_kernels_t *
+itty_bit_matrix_get_kernels_for_operands (itty_bit_matrix_t *result,
+                                          itty_bit_matrix_t *a,
+                                          itty_bit_matrix_t *b)
+{
+        assert (a->number_of_rows == b->number_of_rows && a->number_of_words == b->number_of_words);
+        assert (result->number_of_rows == a->number_of_rows && result->number_of_words == a->number_of_words);
+
+        return itty_bit_string_kernels_get_for_width (a->number_of_rows * a->number_of_words);
+}
+
+static void
+itty_bit_matrix_apply_binary_kernel (itty_bit_matrix_t               *result,
+                                     itty_bit_matrix_t               *a,
+                                     itty_bit_matrix_t               *b,
+                                     itty_bit_string_binary_kernel_t  kernel)
+{
+        size_t number_of_words = a->number_of_rows * a->number_of_words;
+
+        itty_bit_matrix_make_writable (result);
+
+        if (number_of_words > 0)
+                kernel (result->storage->words, a->storage->words, b->storage->words, number_of_words);
+
+        itty_bit_matrix_invalidate (result);
+}
+
+void
+itty_bit_matrix_exclusive_or_into (itty_bit_matrix_t *result,
+                                   itty_bit_matrix_t *a,
+                                   itty_bit_matrix_t *b)
+{
+        const itty_bit_string_kernels_t *kernels = itty_bit_matrix_get_kernels_for_operands (result, a, b);
+
+        itty_bit_matrix_apply_binary_kernel (result, a, b, kernels->exclusive_or);
+}
+
+void
+itty_bit_matrix_mask_into (itty_bit_matrix_t *result,
+                           itty_bit_matrix_t *a,
+                           itty_bit_matrix_t *b)
+{
+        const itty_bit_string_kernels_t *kernels = itty_bit_matrix_get_kernels_for_operands (result, a, b);
+
+        itty_bit_matrix_apply_binary_kernel (result, a, b, kernels->mask);
+}
+
+itty_bit_matrix_t *
+itty_bit_matrix_exclusive_or (itty_bit_matrix_t *a,
+                              itty_bit_matrix_t *b)
+{
+        itty_bit_matrix_t *result = itty_bit_matrix_new (a->number_of_rows, a->number_of_words);
+        itty_bit_matrix_exclusive_or_into (result, a, b);
+        return result;
+}
+
+itty_bit_matrix_t *
+itty_bit_matrix_mask (itty_bit_matrix_t *a,
+                      itty_bit_matrix_t *b)
+{
+        itty_bit_matrix_t *result = itty_bit_matrix_new (a->number_of_rows, a->number_of_words);
+        itty_bit_matrix_mask_into (result, a, b);
+        return result;
+}
+
+itty_bit_matrix_t *
+itty_bit_matrix_exclusive_or_list (itty_bit_matrix_t      *matrix,
+                                   itty_bit_string_list_t *list)
+{
+        size_t number_of_rows = matrix->number_of_rows < list->count ? matrix->number_of_rows : list->count;
+        size_t number_of_words = matrix->number_of_words > list->max_number_of_words ? matrix->number_of_words : list->max_number_of_words;
+        itty_bit_matrix_t *result = itty_bit_matrix_new (number_of_rows, number_of_words);
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+
+        for (size_t row = 0; row < number_of_rows; row++) {
+                size_t *row_words = itty_bit_matrix_get_writable_row_words (result, row);
+                itty_bit_string_t *bit_string = list->bit_strings[row];
+                size_t number_of_string_words = itty_bit_string_get_number_of_words (bit_string);
+
+                if (matrix->number_of_words > 0)
+                        memcpy (row_words, itty_bit_matrix_get_row_words (matrix, row), matrix->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                if (bit_string->sparse != NULL)
+                        itty_bit_string_sparse_exclusive_or_into_words (bit_string->sparse, row_words, number_of_string_words);
+                else if (number_of_string_words > 0)
+                        kernels->exclusive_or (row_words, row_words, bit_string->words, number_of_string_words);
+        }
+
+        return result;
+}
+
+void
+itty_bit_matrix_get_pop_counts (itty_bit_matrix_t *matrix,
+                                size_t            *pop_counts)
+{
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get_for_width (matrix->number_of_words);
+
+        if (matrix->number_of_words == 1) {
+                kernels->pop_count_each_word (pop_counts, matrix->storage->words, matrix->number_of_rows);
+                return;
+        }
+
+        for (size_t row = 0; row < matrix->number_of_rows; row++)
+                pop_counts[row] = kernels->pop_count (itty_bit_matrix_get_row_words (matrix, row), matrix->number_of_words);
+}
+
+itty_bit_matrix_t *
+itty_bit_matrix_transpose (itty_bit_matrix_t *matrix)
+{
+        size_t number_of_rows = matrix->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t number_of_words = (matrix->number_of_rows + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        itty_bit_matrix_t *result = itty_bit_matrix_new (number_of_rows, number_of_words);
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+        size_t tile[ITTY_BIT_STRING_WORD_SIZE_IN_BITS];
+
+        for (size_t word_index = 0; word_index < number_of_words; word_index++) {
+                size_t first_row = word_index * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                size_t number_of_tile_rows = matrix->number_of_rows - first_row;
+
+                if (number_of_tile_rows > ITTY_BIT_STRING_WORD_SIZE_IN_BITS)
+                        number_of_tile_rows = ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+                for (size_t source_word_index = 0; source_word_index < matrix->number_of_words; source_word_index++) {
+                        for (size_t i = 0; i < number_of_tile_rows; i++)
+                                tile[i] = itty_bit_matrix_get_row_words (matrix, first_row + i)[source_word_index];
+                        memset (tile + number_of_tile_rows, 0, (ITTY_BIT_STRING_WORD_SIZE_IN_BITS - number_of_tile_rows) * sizeof (size_t));
+
+                        kernels->transpose (tile);
+
+                        for (size_t bit = 0; bit < ITTY_BIT_STRING_WORD_SIZE_IN_BITS; bit++) {
+                                size_t row = source_word_index * ITTY_BIT_STRING_WORD_SIZE_IN_BITS + bit;
+                                itty_bit_matrix_get_writable_row_words (result, row)[word_index] = tile[bit];
+                        }
+                }
+        }
+
+        return result;
+}
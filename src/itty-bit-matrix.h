@@ -0,0 +1,45 @@
+#pragma once
+
+#include "itty-bit-string.h"
+#include "itty-bit-string-list.h"
+#include <stddef.h>
+
+typedef struct itty_bit_matrix_t itty_bit_matrix_t;
+
+itty_bit_matrix_t *itty_bit_matrix_new (size_t number_of_rows,
+                                        size_t number_of_words);
+itty_bit_matrix_t *itty_bit_matrix_new_for_bit_string (itty_bit_string_t *bit_string,
+                                                       size_t             number_of_rows,
+                                                       size_t             number_of_words);
+itty_bit_matrix_t *itty_bit_matrix_new_from_list (itty_bit_string_list_t *list);
+void itty_bit_matrix_free (itty_bit_matrix_t *matrix);
+
+size_t itty_bit_matrix_get_number_of_rows (itty_bit_matrix_t *matrix);
+size_t itty_bit_matrix_get_number_of_words (itty_bit_matrix_t *matrix);
+
+const size_t *itty_bit_matrix_get_row_words (itty_bit_matrix_t *matrix,
+                                             size_t             row);
+void itty_bit_matrix_set_row (itty_bit_matrix_t *matrix,
+                              size_t             row,
+                              itty_bit_string_t *bit_string);
+itty_bit_string_t *itty_bit_matrix_get_row (itty_bit_matrix_t *matrix,
+                                            size_t             row);
+itty_bit_string_list_t *itty_bit_matrix_get_rows (itty_bit_matrix_t *matrix);
+
+void itty_bit_matrix_exclusive_or_into (itty_bit_matrix_t *result,
+                                        itty_bit_matrix_t *a,
+                                        itty_bit_matrix_t *b);
+void itty_bit_matrix_mask_into (itty_bit_matrix_t *result,
+                                itty_bit_matrix_t *a,
+                                itty_bit_matrix_t *b);
+itty_bit_matrix_t *itty_bit_matrix_exclusive_or (itty_bit_matrix_t *a,
+                                                 itty_bit_matrix_t *b);
+itty_bit_matrix_t *itty_bit_matrix_mask (itty_bit_matrix_t *a,
+                                         itty_bit_matrix_t *b);
+itty_bit_matrix_t *itty_bit_matrix_exclusive_or_list (itty_bit_matrix_t      *matrix,
+                                                      itty_bit_string_list_t *list);
+
+void itty_bit_matrix_get_pop_counts (itty_bit_matrix_t *matrix,
+                                     size_t            *pop_counts);
+
+itty_bit_matrix_t *itty_bit_matrix_transpose (itty_bit_matrix_t *matrix);
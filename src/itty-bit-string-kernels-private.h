@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ITTY_BIT_STRING_KERNELS_MAXIMUM_FIXED_WIDTH 16
+#define ITTY_BIT_STRING_NUMBER_OF_FIXED_WIDTHS 5
+
+#define ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS 4
+#define ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS 8
+
+typedef struct itty_bit_string_kernels_t itty_bit_string_kernels_t;
+typedef enum itty_bit_string_kernel_level_t itty_bit_string_kernel_level_t;
+
+typedef void (* itty_bit_string_binary_kernel_t) (size_t       *result,
+                                                  const size_t *a,
+                                                  const size_t *b,
+                                                  size_t        number_of_words);
+typedef size_t (* itty_bit_string_pop_count_kernel_t) (const size_t *words,
+                                                       size_t        number_of_words);
+typedef size_t (* itty_bit_string_binary_pop_count_kernel_t) (const size_t *a,
+                                                              const size_t *b,
+                                                              size_t        number_of_words);
+typedef void (* itty_bit_string_pop_count_each_word_kernel_t) (size_t       *pop_counts,
+                                                               const size_t *words,
+                                                               size_t        number_of_words);
+typedef void (* itty_bit_string_funnel_shift_kernel_t) (size_t       *result,
+                                                        const size_t *high,
+                                                        const size_t *low,
+                                                        size_t        number_of_words,
+                                                        unsigned int  shift);
+typedef void (* itty_bit_string_transpose_kernel_t) (size_t *words);
+typedef void (* itty_bit_string_exclusive_or_pop_count_tile_kernel_t) (uint32_t     *pop_counts,
+                                                                       const size_t *rows,
+                                                                       const size_t *columns,
+                                                                       size_t        number_of_words);
+
+enum itty_bit_string_kernel_level_t {
+        ITTY_BIT_STRING_KERNEL_LEVEL_SCALAR,
+        ITTY_BIT_STRING_KERNEL_LEVEL_SSE2,
+        ITTY_BIT_STRING_KERNEL_LEVEL_AVX2,
+        ITTY_BIT_STRING_KERNEL_LEVEL_AVX512,
+        ITTY_BIT_STRING_KERNEL_LEVEL_AVX512_VPOPCNTDQ,
+        ITTY_BIT_STRING_NUMBER_OF_KERNEL_LEVELS
+};
+
+/* Kernels take exactly number_of_words words of each operand; a nonzero number_of_words marks a fixed width table */
+struct itty_bit_string_kernels_t {
+        const char                                  *name;
+        itty_bit_string_kernel_level_t               level;
+        size_t                                       number_of_words;
+
+        itty_bit_string_binary_kernel_t              exclusive_nor;
+        itty_bit_string_binary_kernel_t              exclusive_or;
+        itty_bit_string_binary_kernel_t              combine;
+        itty_bit_string_binary_kernel_t              mask;
+
+        itty_bit_string_pop_count_kernel_t           pop_count;
+        itty_bit_string_binary_pop_count_kernel_t    exclusive_nor_pop_count;
+        itty_bit_string_binary_pop_count_kernel_t    exclusive_or_pop_count;
+        itty_bit_string_binary_pop_count_kernel_t    mask_pop_count;
+        itty_bit_string_pop_count_each_word_kernel_t pop_count_each_word;
+
+        itty_bit_string_funnel_shift_kernel_t        funnel_shift;
+        itty_bit_string_transpose_kernel_t           transpose;
+
+        itty_bit_string_exclusive_or_pop_count_tile_kernel_t exclusive_or_pop_count_tile;
+};
+
+const itty_bit_string_kernels_t *itty_bit_string_kernels_get (void);
+const itty_bit_string_kernels_t *itty_bit_string_kernels_get_for_level (itty_bit_string_kernel_level_t level);
+const itty_bit_string_kernels_t *itty_bit_string_kernels_get_for_width (size_t number_of_words);
+const itty_bit_string_kernels_t *itty_bit_string_kernels_get_for_level_and_width (itty_bit_string_kernel_level_t level,
+                                                                                  size_t                         number_of_words);
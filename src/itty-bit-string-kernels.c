@@ -0,0 +1,938 @@
+#include "itty-bit-string-kernels-private.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined (__x86_64__)
+#define ITTY_BIT_STRING_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+#define ITTY_DEFINE_SCALAR_BINARY_KERNEL(name, expression)                              \
+static void                                                                             \
+itty_bit_string_scalar_##name (size_t       *result,                                    \
+                               const size_t *a,                                         \
+                               const size_t *b,                                         \
+                               size_t        number_of_words)                           \
+{                                                                                       \
+        for (size_t i = 0; i < number_of_words; i++) {                                  \
+                size_t x = a[i];                                                        \
+                size_t y = b[i];                                                        \
+                result[i] = (expression);                                               \
+        }                                                                               \
+}
+
+ITTY_DEFINE_SCALAR_BINARY_KERNEL (exclusive_nor, ~(x ^ y))
+ITTY_DEFINE_SCALAR_BINARY_KERNEL (exclusive_or, x ^ y)
+ITTY_DEFINE_SCALAR_BINARY_KERNEL (combine, x | y)
+ITTY_DEFINE_SCALAR_BINARY_KERNEL (mask, x & y)
+
+#define ITTY_DEFINE_SCALAR_BINARY_POP_COUNT_KERNEL(name, expression)                    \
+static size_t                                                                           \
+itty_bit_string_scalar_##name##_pop_count (const size_t *a,                             \
+                                           const size_t *b,                             \
+                                           size_t        number_of_words)               \
+{                                                                                       \
+        size_t pop_count = 0;                                                           \
+                                                                                        \
+        for (size_t i = 0; i < number_of_words; i++) {                                  \
+                size_t x = a[i];                                                        \
+                size_t y = b[i];                                                        \
+                pop_count += __builtin_popcountl (expression);                          \
+        }                                                                               \
+                                                                                        \
+        return pop_count;                                                               \
+}
+
+static size_t
+itty_bit_string_scalar_pop_count (const size_t *words,
+                                  size_t        number_of_words)
+{
+        size_t pop_count = 0;
+
+        for (size_t i = 0; i < number_of_words; i++) {
+                pop_count += __builtin_popcountl (words[i]);
+        }
+
+        return pop_count;
+}
+
+static void
+itty_bit_string_scalar_pop_count_each_word (size_t       *pop_counts,
+                                            const size_t *words,
+                                            size_t        number_of_words)
+{
+        for (size_t i = 0; i < number_of_words; i++) {
+                pop_counts[i] = __builtin_popcountl (words[i]);
+        }
+}
+
+ITTY_DEFINE_SCALAR_BINARY_POP_COUNT_KERNEL (exclusive_nor, ~(x ^ y))
+ITTY_DEFINE_SCALAR_BINARY_POP_COUNT_KERNEL (exclusive_or, x ^ y)
+ITTY_DEFINE_SCALAR_BINARY_POP_COUNT_KERNEL (mask, x & y)
+
+static void
+itty_bit_string_scalar_funnel_shift (size_t       *result,
+                                     const size_t *high,
+                                     const size_t *low,
+                                     size_t        number_of_words,
+                                     unsigned int  shift)
+{
+        for (size_t i = 0; i < number_of_words; i++) {
+                result[i] = (high[i] << shift) | (low[i] >> (64 - shift));
+        }
+}
+
+static void
+itty_bit_string_scalar_transpose (size_t *words)
+{
+        size_t mask = 0x00000000ffffffffUL;
+
+        for (unsigned int j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+                for (size_t k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+                        size_t t = ((words[k] >> j) ^ words[k | j]) & mask;
+
+                        words[k] ^= t << j;
+                        words[k | j] ^= t;
+                }
+        }
+}
+
+static void
+itty_bit_string_scalar_exclusive_or_pop_count_tile (uint32_t     *pop_counts,
+                                                    const size_t *rows,
+                                                    const size_t *columns,
+                                                    size_t        number_of_words)
+{
+        size_t tile[ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS] = { 0 };
+
+        for (size_t k = 0; k < number_of_words; k++) {
+                const size_t *column_words = columns + k * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS;
+
+                for (size_t i = 0; i < ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS; i++) {
+                        size_t x = rows[i * number_of_words + k];
+
+                        for (size_t j = 0; j < ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS; j++)
+                                tile[i * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS + j] += __builtin_popcountl (x ^ column_words[j]);
+                }
+        }
+
+        for (size_t i = 0; i < ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS; i++)
+                pop_counts[i] = tile[i];
+}
+
+static const itty_bit_string_kernels_t itty_bit_string_scalar_kernels = {
+        .name = "scalar",
+        .level = ITTY_BIT_STRING_KERNEL_LEVEL_SCALAR,
+        .exclusive_nor = itty_bit_string_scalar_exclusive_nor,
+        .exclusive_or = itty_bit_string_scalar_exclusive_or,
+        .combine = itty_bit_string_scalar_combine,
+        .mask = itty_bit_string_scalar_mask,
+        .pop_count = itty_bit_string_scalar_pop_count,
+        .exclusive_nor_pop_count = itty_bit_string_scalar_exclusive_nor_pop_count,
+        .exclusive_or_pop_count = itty_bit_string_scalar_exclusive_or_pop_count,
+        .mask_pop_count = itty_bit_string_scalar_mask_pop_count,
+        .pop_count_each_word = itty_bit_string_scalar_pop_count_each_word,
+        .funnel_shift = itty_bit_string_scalar_funnel_shift,
+        .transpose = itty_bit_string_scalar_transpose,
+        .exclusive_or_pop_count_tile = itty_bit_string_scalar_exclusive_or_pop_count_tile,
+};
+
+#define ITTY_DEFINE_FIXED_WIDTH_BINARY_KERNEL(level, attributes, vector_type, load, store, name, expression, scalar_expression, width) \
+static attributes void                                                                  \
+itty_bit_string_##level##_##name##_##width (size_t       *result,                       \
+                                            const size_t *a,                            \
+                                            const size_t *b,                            \
+                                            size_t        number_of_words)              \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        size_t i = 0;                                                                   \
+                                                                                        \
+        (void) number_of_words;                                                         \
+                                                                                        \
+        _Pragma ("GCC unroll 16")                                                       \
+        for (; i + words_per_vector <= width; i += words_per_vector) {                  \
+                vector_type x = load ((const vector_type *) (a + i));                   \
+                vector_type y = load ((const vector_type *) (b + i));                   \
+                store ((vector_type *) (result + i), (expression));                     \
+        }                                                                               \
+                                                                                        \
+        _Pragma ("GCC unroll 16")                                                       \
+        for (; i < width; i++) {                                                        \
+                size_t x = a[i];                                                        \
+                size_t y = b[i];                                                        \
+                result[i] = (scalar_expression);                                        \
+        }                                                                               \
+}
+
+#define ITTY_DEFINE_FIXED_WIDTH_BINARY_POP_COUNT_KERNEL(level, attributes, vector_type, load, add, name, expression, scalar_expression, width) \
+static attributes size_t                                                                \
+itty_bit_string_##level##_##name##_pop_count_##width (const size_t *a,                  \
+                                                      const size_t *b,                  \
+                                                      size_t        number_of_words)    \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        vector_type lane_pop_counts = { 0 };                                            \
+        uint64_t lanes[sizeof (vector_type) / sizeof (uint64_t)];                       \
+        size_t pop_count = 0;                                                           \
+        size_t i = 0;                                                                   \
+                                                                                        \
+        (void) number_of_words;                                                         \
+                                                                                        \
+        _Pragma ("GCC unroll 16")                                                       \
+        for (; i + words_per_vector <= width; i += words_per_vector) {                  \
+                vector_type x = load ((const vector_type *) (a + i));                   \
+                vector_type y = load ((const vector_type *) (b + i));                   \
+                lane_pop_counts = add (lane_pop_counts,                                 \
+                                       itty_bit_string_##level##_pop_count_lanes (expression)); \
+        }                                                                               \
+                                                                                        \
+        memcpy (lanes, &lane_pop_counts, sizeof (lanes));                               \
+        for (size_t lane = 0; lane < sizeof (lanes) / sizeof (lanes[0]); lane++)        \
+                pop_count += lanes[lane];                                               \
+                                                                                        \
+        _Pragma ("GCC unroll 16")                                                       \
+        for (; i < width; i++) {                                                        \
+                size_t x = a[i];                                                        \
+                size_t y = b[i];                                                        \
+                pop_count += __builtin_popcountl (scalar_expression);                   \
+        }                                                                               \
+                                                                                        \
+        return pop_count;                                                               \
+}
+
+#define ITTY_DEFINE_FIXED_WIDTH_POP_COUNT_KERNEL(level, attributes, vector_type, load, add, width) \
+static attributes size_t                                                                \
+itty_bit_string_##level##_pop_count_##width (const size_t *words,                       \
+                                             size_t        number_of_words)             \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        vector_type lane_pop_counts = { 0 };                                            \
+        uint64_t lanes[sizeof (vector_type) / sizeof (uint64_t)];                       \
+        size_t pop_count = 0;                                                           \
+        size_t i = 0;                                                                   \
+                                                                                        \
+        (void) number_of_words;                                                         \
+                                                                                        \
+        _Pragma ("GCC unroll 16")                                                       \
+        for (; i + words_per_vector <= width; i += words_per_vector) {                  \
+                vector_type x = load ((const vector_type *) (words + i));               \
+                lane_pop_counts = add (lane_pop_counts,                                 \
+                                       itty_bit_string_##level##_pop_count_lanes (x));  \
+        }                                                                               \
+                                                                                        \
+        memcpy (lanes, &lane_pop_counts, sizeof (lanes));                               \
+        for (size_t lane = 0; lane < sizeof (lanes) / sizeof (lanes[0]); lane++)        \
+                pop_count += lanes[lane];                                               \
+                                                                                        \
+        _Pragma ("GCC unroll 16")                                                       \
+        for (; i < width; i++)                                                          \
+                pop_count += __builtin_popcountl (words[i]);                            \
+                                                                                        \
+        return pop_count;                                                               \
+}
+
+/* Width independent entries point at the level's generic kernels */
+#define ITTY_DEFINE_FIXED_WIDTH_KERNELS(prefix, level_name, level_value, attributes, vector_type, load, store, add, \
+                                        exclusive_nor_expression, exclusive_or_expression, combine_expression, mask_expression, \
+                                        pop_count_each_word_kernel, funnel_shift_kernel, transpose_kernel, \
+                                        exclusive_or_pop_count_tile_kernel, width) \
+ITTY_DEFINE_FIXED_WIDTH_BINARY_KERNEL (prefix, attributes, vector_type, load, store, exclusive_nor, exclusive_nor_expression, ~(x ^ y), width) \
+ITTY_DEFINE_FIXED_WIDTH_BINARY_KERNEL (prefix, attributes, vector_type, load, store, exclusive_or, exclusive_or_expression, x ^ y, width) \
+ITTY_DEFINE_FIXED_WIDTH_BINARY_KERNEL (prefix, attributes, vector_type, load, store, combine, combine_expression, x | y, width) \
+ITTY_DEFINE_FIXED_WIDTH_BINARY_KERNEL (prefix, attributes, vector_type, load, store, mask, mask_expression, x & y, width) \
+ITTY_DEFINE_FIXED_WIDTH_POP_COUNT_KERNEL (prefix, attributes, vector_type, load, add, width) \
+ITTY_DEFINE_FIXED_WIDTH_BINARY_POP_COUNT_KERNEL (prefix, attributes, vector_type, load, add, exclusive_nor, exclusive_nor_expression, ~(x ^ y), width) \
+ITTY_DEFINE_FIXED_WIDTH_BINARY_POP_COUNT_KERNEL (prefix, attributes, vector_type, load, add, exclusive_or, exclusive_or_expression, x ^ y, width) \
+ITTY_DEFINE_FIXED_WIDTH_BINARY_POP_COUNT_KERNEL (prefix, attributes, vector_type, load, add, mask, mask_expression, x & y, width) \
+                                                                                        \
+static const itty_bit_string_kernels_t itty_bit_string_##prefix##_kernels_##width = {   \
+        .name = level_name,                                                             \
+        .level = level_value,                                                           \
+        .number_of_words = width,                                                       \
+        .exclusive_nor = itty_bit_string_##prefix##_exclusive_nor_##width,              \
+        .exclusive_or = itty_bit_string_##prefix##_exclusive_or_##width,                \
+        .combine = itty_bit_string_##prefix##_combine_##width,                          \
+        .mask = itty_bit_string_##prefix##_mask_##width,                                \
+        .pop_count = itty_bit_string_##prefix##_pop_count_##width,                      \
+        .exclusive_nor_pop_count = itty_bit_string_##prefix##_exclusive_nor_pop_count_##width, \
+        .exclusive_or_pop_count = itty_bit_string_##prefix##_exclusive_or_pop_count_##width, \
+        .mask_pop_count = itty_bit_string_##prefix##_mask_pop_count_##width,            \
+        .pop_count_each_word = pop_count_each_word_kernel,                              \
+        .funnel_shift = funnel_shift_kernel,                                            \
+        .transpose = transpose_kernel,                                                  \
+        .exclusive_or_pop_count_tile = exclusive_or_pop_count_tile_kernel,              \
+};
+
+static inline size_t
+itty_bit_string_scalar_load (const size_t *word)
+{
+        return *word;
+}
+
+static inline void
+itty_bit_string_scalar_store (size_t *word,
+                              size_t  value)
+{
+        *word = value;
+}
+
+static inline size_t
+itty_bit_string_scalar_add (size_t a,
+                            size_t b)
+{
+        return a + b;
+}
+
+static inline size_t
+itty_bit_string_scalar_pop_count_lanes (size_t word)
+{
+        return __builtin_popcountl (word);
+}
+
+#define ITTY_DEFINE_SCALAR_FIXED_WIDTH_KERNELS(width) \
+        ITTY_DEFINE_FIXED_WIDTH_KERNELS (scalar, "scalar", ITTY_BIT_STRING_KERNEL_LEVEL_SCALAR, , size_t, \
+                                         itty_bit_string_scalar_load, itty_bit_string_scalar_store, itty_bit_string_scalar_add, \
+                                         ~(x ^ y), x ^ y, x | y, x & y, \
+                                         itty_bit_string_scalar_pop_count_each_word, itty_bit_string_scalar_funnel_shift, \
+                                         itty_bit_string_scalar_transpose, \
+                                         itty_bit_string_scalar_exclusive_or_pop_count_tile, width)
+
+ITTY_DEFINE_SCALAR_FIXED_WIDTH_KERNELS (1)
+ITTY_DEFINE_SCALAR_FIXED_WIDTH_KERNELS (2)
+ITTY_DEFINE_SCALAR_FIXED_WIDTH_KERNELS (4)
+ITTY_DEFINE_SCALAR_FIXED_WIDTH_KERNELS (8)
+ITTY_DEFINE_SCALAR_FIXED_WIDTH_KERNELS (16)
+
+#ifdef ITTY_BIT_STRING_KERNELS_X86
+
+#define ITTY_DEFINE_VECTOR_BINARY_KERNEL(level, target_name, vector_type, load, store, name, expression) \
+static __attribute__ ((target (target_name))) void                                      \
+itty_bit_string_##level##_##name (size_t       *result,                                 \
+                                  const size_t *a,                                      \
+                                  const size_t *b,                                      \
+                                  size_t        number_of_words)                        \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        size_t i = 0;                                                                   \
+                                                                                        \
+        for (; i + words_per_vector <= number_of_words; i += words_per_vector) {        \
+                vector_type x = load ((const vector_type *) (a + i));                   \
+                vector_type y = load ((const vector_type *) (b + i));                   \
+                store ((vector_type *) (result + i), (expression));                     \
+        }                                                                               \
+                                                                                        \
+        itty_bit_string_scalar_##name (result + i, a + i, b + i, number_of_words - i);  \
+}
+
+#define ITTY_DEFINE_VECTOR_BINARY_POP_COUNT_KERNEL(level, target_name, vector_type, load, add, name, expression) \
+static __attribute__ ((target (target_name))) size_t                                    \
+itty_bit_string_##level##_##name##_pop_count (const size_t *a,                          \
+                                              const size_t *b,                          \
+                                              size_t        number_of_words)            \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        vector_type lane_pop_counts = { 0 };                                            \
+        uint64_t lanes[sizeof (vector_type) / sizeof (uint64_t)];                       \
+        size_t pop_count = 0;                                                           \
+        size_t i = 0;                                                                   \
+                                                                                        \
+        for (; i + words_per_vector <= number_of_words; i += words_per_vector) {        \
+                vector_type x = load ((const vector_type *) (a + i));                   \
+                vector_type y = load ((const vector_type *) (b + i));                   \
+                lane_pop_counts = add (lane_pop_counts,                                 \
+                                       itty_bit_string_##level##_pop_count_lanes (expression)); \
+        }                                                                               \
+                                                                                        \
+        memcpy (lanes, &lane_pop_counts, sizeof (lanes));                               \
+        for (size_t lane = 0; lane < sizeof (lanes) / sizeof (lanes[0]); lane++)        \
+                pop_count += lanes[lane];                                               \
+                                                                                        \
+        return pop_count + itty_bit_string_scalar_##name##_pop_count (a + i, b + i, number_of_words - i); \
+}
+
+#define ITTY_DEFINE_VECTOR_POP_COUNT_KERNEL(level, target_name, vector_type, load, add)  \
+static __attribute__ ((target (target_name))) size_t                                    \
+itty_bit_string_##level##_pop_count (const size_t *words,                               \
+                                     size_t        number_of_words)                     \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        vector_type lane_pop_counts = { 0 };                                            \
+        uint64_t lanes[sizeof (vector_type) / sizeof (uint64_t)];                       \
+        size_t pop_count = 0;                                                           \
+        size_t i = 0;                                                                   \
+                                                                                        \
+        for (; i + words_per_vector <= number_of_words; i += words_per_vector) {        \
+                vector_type x = load ((const vector_type *) (words + i));               \
+                lane_pop_counts = add (lane_pop_counts,                                 \
+                                       itty_bit_string_##level##_pop_count_lanes (x));  \
+        }                                                                               \
+                                                                                        \
+        memcpy (lanes, &lane_pop_counts, sizeof (lanes));                               \
+        for (size_t lane = 0; lane < sizeof (lanes) / sizeof (lanes[0]); lane++)        \
+                pop_count += lanes[lane];                                               \
+                                                                                        \
+        return pop_count + itty_bit_string_scalar_pop_count (words + i, number_of_words - i); \
+}
+
+#define ITTY_DEFINE_VECTOR_POP_COUNT_EACH_WORD_KERNEL(level, target_name, vector_type, load, store) \
+static __attribute__ ((target (target_name))) void                                      \
+itty_bit_string_##level##_pop_count_each_word (size_t       *pop_counts,                \
+                                               const size_t *words,                     \
+                                               size_t        number_of_words)           \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        size_t i = 0;                                                                   \
+                                                                                        \
+        for (; i + words_per_vector <= number_of_words; i += words_per_vector) {        \
+                vector_type x = load ((const vector_type *) (words + i));               \
+                store ((vector_type *) (pop_counts + i), itty_bit_string_##level##_pop_count_lanes (x)); \
+        }                                                                               \
+                                                                                        \
+        itty_bit_string_scalar_pop_count_each_word (pop_counts + i, words + i, number_of_words - i); \
+}
+
+#define ITTY_DEFINE_VECTOR_FUNNEL_SHIFT_KERNEL(level, target_name, vector_type, load, store, bitwise_or, shift_left, shift_right) \
+static __attribute__ ((target (target_name))) void                                      \
+itty_bit_string_##level##_funnel_shift (size_t       *result,                           \
+                                        const size_t *high,                             \
+                                        const size_t *low,                              \
+                                        size_t        number_of_words,                  \
+                                        unsigned int  shift)                            \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        const __m128i left_count = _mm_cvtsi32_si128 (shift);                           \
+        const __m128i right_count = _mm_cvtsi32_si128 (64 - shift);                     \
+        size_t i = 0;                                                                   \
+                                                                                        \
+        for (; i + words_per_vector <= number_of_words; i += words_per_vector) {        \
+                vector_type x = load ((const vector_type *) (high + i));                \
+                vector_type y = load ((const vector_type *) (low + i));                 \
+                store ((vector_type *) (result + i),                                    \
+                       bitwise_or (shift_left (x, left_count), shift_right (y, right_count))); \
+        }                                                                               \
+                                                                                        \
+        itty_bit_string_scalar_funnel_shift (result + i, high + i, low + i, number_of_words - i, shift); \
+}
+
+#define ITTY_DEFINE_VECTOR_EXCLUSIVE_OR_POP_COUNT_TILE_KERNEL(level, target_name, vector_type, load, add, broadcast, exclusive_or) \
+static __attribute__ ((target (target_name))) void                                      \
+itty_bit_string_##level##_exclusive_or_pop_count_tile (uint32_t     *pop_counts,        \
+                                                       const size_t *rows,              \
+                                                       const size_t *columns,           \
+                                                       size_t        number_of_words)   \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        const size_t vectors_per_row = ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS / words_per_vector; \
+        vector_type tile[ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS][ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS * sizeof (size_t) / sizeof (vector_type)]; \
+        vector_type column_vectors[ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS * sizeof (size_t) / sizeof (vector_type)]; \
+        uint64_t lanes[ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS]; \
+                                                                                        \
+        for (size_t i = 0; i < ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS; i++)                \
+                for (size_t v = 0; v < vectors_per_row; v++)                            \
+                        tile[i][v] = (vector_type) { 0 };                               \
+                                                                                        \
+        for (size_t k = 0; k < number_of_words; k++) {                                  \
+                const size_t *column_words = columns + k * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS; \
+                                                                                        \
+                for (size_t v = 0; v < vectors_per_row; v++)                            \
+                        column_vectors[v] = load ((const vector_type *) (column_words + v * words_per_vector)); \
+                                                                                        \
+                for (size_t i = 0; i < ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS; i++) {      \
+                        vector_type x = broadcast (rows[i * number_of_words + k]);      \
+                                                                                        \
+                        for (size_t v = 0; v < vectors_per_row; v++)                    \
+                                tile[i][v] = add (tile[i][v],                           \
+                                                  itty_bit_string_##level##_pop_count_lanes (exclusive_or (x, column_vectors[v]))); \
+                }                                                                       \
+        }                                                                               \
+                                                                                        \
+        memcpy (lanes, tile, sizeof (lanes));                                           \
+        for (size_t i = 0; i < ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS; i++) \
+                pop_counts[i] = lanes[i];                                               \
+}
+
+/* Harley-Seal population count */
+#define ITTY_DEFINE_HARLEY_SEAL_POP_COUNT_KERNEL(level, target_name, vector_type, load, add, shift_left) \
+static __attribute__ ((target (target_name))) size_t                                    \
+itty_bit_string_##level##_pop_count (const size_t *words,                               \
+                                     size_t        number_of_words)                     \
+{                                                                                       \
+        const size_t words_per_vector = sizeof (vector_type) / sizeof (size_t);         \
+        const vector_type *vectors = (const vector_type *) words;                       \
+        size_t number_of_vectors = number_of_words / words_per_vector;                  \
+        vector_type total = { 0 };                                                      \
+        vector_type ones = { 0 }, twos = { 0 }, fours = { 0 }, eights = { 0 };          \
+        vector_type sixteens;                                                           \
+        vector_type twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;               \
+        uint64_t lanes[sizeof (vector_type) / sizeof (uint64_t)];                       \
+        size_t pop_count = 0;                                                           \
+        size_t i = 0;                                                                   \
+                                                                                        \
+        for (; i + 16 <= number_of_vectors; i += 16) {                                  \
+                itty_bit_string_##level##_carry_save_add (&twos_a, &ones, ones, load (vectors + i + 0), load (vectors + i + 1)); \
+                itty_bit_string_##level##_carry_save_add (&twos_b, &ones, ones, load (vectors + i + 2), load (vectors + i + 3)); \
+                itty_bit_string_##level##_carry_save_add (&fours_a, &twos, twos, twos_a, twos_b); \
+                itty_bit_string_##level##_carry_save_add (&twos_a, &ones, ones, load (vectors + i + 4), load (vectors + i + 5)); \
+                itty_bit_string_##level##_carry_save_add (&twos_b, &ones, ones, load (vectors + i + 6), load (vectors + i + 7)); \
+                itty_bit_string_##level##_carry_save_add (&fours_b, &twos, twos, twos_a, twos_b); \
+                itty_bit_string_##level##_carry_save_add (&eights_a, &fours, fours, fours_a, fours_b); \
+                itty_bit_string_##level##_carry_save_add (&twos_a, &ones, ones, load (vectors + i + 8), load (vectors + i + 9)); \
+                itty_bit_string_##level##_carry_save_add (&twos_b, &ones, ones, load (vectors + i + 10), load (vectors + i + 11)); \
+                itty_bit_string_##level##_carry_save_add (&fours_a, &twos, twos, twos_a, twos_b); \
+                itty_bit_string_##level##_carry_save_add (&twos_a, &ones, ones, load (vectors + i + 12), load (vectors + i + 13)); \
+                itty_bit_string_##level##_carry_save_add (&twos_b, &ones, ones, load (vectors + i + 14), load (vectors + i + 15)); \
+                itty_bit_string_##level##_carry_save_add (&fours_b, &twos, twos, twos_a, twos_b); \
+                itty_bit_string_##level##_carry_save_add (&eights_b, &fours, fours, fours_a, fours_b); \
+                itty_bit_string_##level##_carry_save_add (&sixteens, &eights, eights, eights_a, eights_b); \
+                total = add (total, itty_bit_string_##level##_pop_count_lanes (sixteens)); \
+        }                                                                               \
+                                                                                        \
+        total = shift_left (total, 4);                                                  \
+        total = add (total, shift_left (itty_bit_string_##level##_pop_count_lanes (eights), 3)); \
+        total = add (total, shift_left (itty_bit_string_##level##_pop_count_lanes (fours), 2)); \
+        total = add (total, shift_left (itty_bit_string_##level##_pop_count_lanes (twos), 1)); \
+        total = add (total, itty_bit_string_##level##_pop_count_lanes (ones));          \
+                                                                                        \
+        for (; i < number_of_vectors; i++)                                              \
+                total = add (total, itty_bit_string_##level##_pop_count_lanes (load (vectors + i))); \
+                                                                                        \
+        memcpy (lanes, &total, sizeof (lanes));                                         \
+        for (size_t lane = 0; lane < sizeof (lanes) / sizeof (lanes[0]); lane++)        \
+                pop_count += lanes[lane];                                               \
+                                                                                        \
+        i *= words_per_vector;                                                          \
+        return pop_count + itty_bit_string_scalar_pop_count (words + i, number_of_words - i); \
+}
+
+static inline __attribute__ ((target ("sse2"))) __m128i
+itty_bit_string_sse2_pop_count_lanes (__m128i v)
+{
+        const __m128i m1 = _mm_set1_epi8 (0x55);
+        const __m128i m2 = _mm_set1_epi8 (0x33);
+        const __m128i m4 = _mm_set1_epi8 (0x0f);
+
+        v = _mm_sub_epi8 (v, _mm_and_si128 (_mm_srli_epi64 (v, 1), m1));
+        v = _mm_add_epi8 (_mm_and_si128 (v, m2), _mm_and_si128 (_mm_srli_epi64 (v, 2), m2));
+        v = _mm_and_si128 (_mm_add_epi8 (v, _mm_srli_epi64 (v, 4)), m4);
+
+        return _mm_sad_epu8 (v, _mm_setzero_si128 ());
+}
+
+#define ITTY_DEFINE_SSE2_BINARY_KERNEL(name, expression) \
+        ITTY_DEFINE_VECTOR_BINARY_KERNEL (sse2, "sse2", __m128i, _mm_loadu_si128, _mm_storeu_si128, name, expression)
+
+ITTY_DEFINE_SSE2_BINARY_KERNEL (exclusive_nor, _mm_xor_si128 (_mm_xor_si128 (x, y), _mm_set1_epi32 (-1)))
+ITTY_DEFINE_SSE2_BINARY_KERNEL (exclusive_or, _mm_xor_si128 (x, y))
+ITTY_DEFINE_SSE2_BINARY_KERNEL (combine, _mm_or_si128 (x, y))
+ITTY_DEFINE_SSE2_BINARY_KERNEL (mask, _mm_and_si128 (x, y))
+
+ITTY_DEFINE_VECTOR_POP_COUNT_KERNEL (sse2, "sse2", __m128i, _mm_loadu_si128, _mm_add_epi64)
+ITTY_DEFINE_VECTOR_POP_COUNT_EACH_WORD_KERNEL (sse2, "sse2", __m128i, _mm_loadu_si128, _mm_storeu_si128)
+
+ITTY_DEFINE_VECTOR_FUNNEL_SHIFT_KERNEL (sse2, "sse2", __m128i, _mm_loadu_si128, _mm_storeu_si128, _mm_or_si128, _mm_sll_epi64, _mm_srl_epi64)
+ITTY_DEFINE_VECTOR_EXCLUSIVE_OR_POP_COUNT_TILE_KERNEL (sse2, "sse2", __m128i, _mm_loadu_si128, _mm_add_epi64, _mm_set1_epi64x, _mm_xor_si128)
+
+#define ITTY_DEFINE_SSE2_BINARY_POP_COUNT_KERNEL(name, expression) \
+        ITTY_DEFINE_VECTOR_BINARY_POP_COUNT_KERNEL (sse2, "sse2", __m128i, _mm_loadu_si128, _mm_add_epi64, name, expression)
+
+ITTY_DEFINE_SSE2_BINARY_POP_COUNT_KERNEL (exclusive_nor, _mm_xor_si128 (_mm_xor_si128 (x, y), _mm_set1_epi32 (-1)))
+ITTY_DEFINE_SSE2_BINARY_POP_COUNT_KERNEL (exclusive_or, _mm_xor_si128 (x, y))
+ITTY_DEFINE_SSE2_BINARY_POP_COUNT_KERNEL (mask, _mm_and_si128 (x, y))
+
+static const itty_bit_string_kernels_t itty_bit_string_sse2_kernels = {
+        .name = "sse2",
+        .level = ITTY_BIT_STRING_KERNEL_LEVEL_SSE2,
+        .exclusive_nor = itty_bit_string_sse2_exclusive_nor,
+        .exclusive_or = itty_bit_string_sse2_exclusive_or,
+        .combine = itty_bit_string_sse2_combine,
+        .mask = itty_bit_string_sse2_mask,
+        .pop_count = itty_bit_string_sse2_pop_count,
+        .exclusive_nor_pop_count = itty_bit_string_sse2_exclusive_nor_pop_count,
+        .exclusive_or_pop_count = itty_bit_string_sse2_exclusive_or_pop_count,
+        .mask_pop_count = itty_bit_string_sse2_mask_pop_count,
+        .pop_count_each_word = itty_bit_string_sse2_pop_count_each_word,
+        .funnel_shift = itty_bit_string_sse2_funnel_shift,
+        .transpose = itty_bit_string_scalar_transpose,
+        .exclusive_or_pop_count_tile = itty_bit_string_sse2_exclusive_or_pop_count_tile,
+};
+
+#define ITTY_DEFINE_SSE2_FIXED_WIDTH_KERNELS(width) \
+        ITTY_DEFINE_FIXED_WIDTH_KERNELS (sse2, "sse2", ITTY_BIT_STRING_KERNEL_LEVEL_SSE2, __attribute__ ((target ("sse2"))), __m128i, \
+                                         _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi64, \
+                                         _mm_xor_si128 (_mm_xor_si128 (x, y), _mm_set1_epi32 (-1)), _mm_xor_si128 (x, y), \
+                                         _mm_or_si128 (x, y), _mm_and_si128 (x, y), \
+                                         itty_bit_string_sse2_pop_count_each_word, itty_bit_string_sse2_funnel_shift, \
+                                         itty_bit_string_scalar_transpose, \
+                                         itty_bit_string_sse2_exclusive_or_pop_count_tile, width)
+
+ITTY_DEFINE_SSE2_FIXED_WIDTH_KERNELS (1)
+ITTY_DEFINE_SSE2_FIXED_WIDTH_KERNELS (2)
+ITTY_DEFINE_SSE2_FIXED_WIDTH_KERNELS (4)
+ITTY_DEFINE_SSE2_FIXED_WIDTH_KERNELS (8)
+ITTY_DEFINE_SSE2_FIXED_WIDTH_KERNELS (16)
+
+static inline __attribute__ ((target ("avx2"))) __m256i
+itty_bit_string_avx2_pop_count_lanes (__m256i v)
+{
+        const __m256i lookup = _mm256_setr_epi8 (0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low_nibbles = _mm256_set1_epi8 (0x0f);
+
+        __m256i low = _mm256_and_si256 (v, low_nibbles);
+        __m256i high = _mm256_and_si256 (_mm256_srli_epi64 (v, 4), low_nibbles);
+        __m256i counts = _mm256_add_epi8 (_mm256_shuffle_epi8 (lookup, low),
+                                          _mm256_shuffle_epi8 (lookup, high));
+
+        return _mm256_sad_epu8 (counts, _mm256_setzero_si256 ());
+}
+
+static inline __attribute__ ((target ("avx2"))) void
+itty_bit_string_avx2_carry_save_add (__m256i *high,
+                                     __m256i *low,
+                                     __m256i  a,
+                                     __m256i  b,
+                                     __m256i  c)
+{
+        __m256i u = _mm256_xor_si256 (a, b);
+
+        *high = _mm256_or_si256 (_mm256_and_si256 (a, b), _mm256_and_si256 (u, c));
+        *low = _mm256_xor_si256 (u, c);
+}
+
+#define ITTY_DEFINE_AVX2_BINARY_KERNEL(name, expression) \
+        ITTY_DEFINE_VECTOR_BINARY_KERNEL (avx2, "avx2", __m256i, _mm256_loadu_si256, _mm256_storeu_si256, name, expression)
+
+ITTY_DEFINE_AVX2_BINARY_KERNEL (exclusive_nor, _mm256_xor_si256 (_mm256_xor_si256 (x, y), _mm256_set1_epi32 (-1)))
+ITTY_DEFINE_AVX2_BINARY_KERNEL (exclusive_or, _mm256_xor_si256 (x, y))
+ITTY_DEFINE_AVX2_BINARY_KERNEL (combine, _mm256_or_si256 (x, y))
+ITTY_DEFINE_AVX2_BINARY_KERNEL (mask, _mm256_and_si256 (x, y))
+
+ITTY_DEFINE_HARLEY_SEAL_POP_COUNT_KERNEL (avx2, "avx2", __m256i, _mm256_loadu_si256, _mm256_add_epi64, _mm256_slli_epi64)
+ITTY_DEFINE_VECTOR_POP_COUNT_EACH_WORD_KERNEL (avx2, "avx2", __m256i, _mm256_loadu_si256, _mm256_storeu_si256)
+
+ITTY_DEFINE_VECTOR_FUNNEL_SHIFT_KERNEL (avx2, "avx2", __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_or_si256, _mm256_sll_epi64, _mm256_srl_epi64)
+ITTY_DEFINE_VECTOR_EXCLUSIVE_OR_POP_COUNT_TILE_KERNEL (avx2, "avx2", __m256i, _mm256_loadu_si256, _mm256_add_epi64, _mm256_set1_epi64x, _mm256_xor_si256)
+
+#define ITTY_DEFINE_AVX2_BINARY_POP_COUNT_KERNEL(name, expression) \
+        ITTY_DEFINE_VECTOR_BINARY_POP_COUNT_KERNEL (avx2, "avx2", __m256i, _mm256_loadu_si256, _mm256_add_epi64, name, expression)
+
+ITTY_DEFINE_AVX2_BINARY_POP_COUNT_KERNEL (exclusive_nor, _mm256_xor_si256 (_mm256_xor_si256 (x, y), _mm256_set1_epi32 (-1)))
+ITTY_DEFINE_AVX2_BINARY_POP_COUNT_KERNEL (exclusive_or, _mm256_xor_si256 (x, y))
+ITTY_DEFINE_AVX2_BINARY_POP_COUNT_KERNEL (mask, _mm256_and_si256 (x, y))
+
+/* The AVX-512 levels share this kernel, 64 words don't fill enough 512-bit vectors */
+static __attribute__ ((target ("avx2"))) void
+itty_bit_string_avx2_transpose (size_t *words)
+{
+        size_t mask = 0x00000000ffffffffUL;
+
+        for (unsigned int j = 32; j >= 4; j >>= 1, mask ^= mask << j) {
+                const __m256i vector_mask = _mm256_set1_epi64x (mask);
+                const __m128i count = _mm_cvtsi32_si128 (j);
+
+                for (size_t base = 0; base < 64; base += 2 * j) {
+                        for (size_t k = base; k < base + j; k += 4) {
+                                __m256i x = _mm256_loadu_si256 ((const __m256i *) (words + k));
+                                __m256i y = _mm256_loadu_si256 ((const __m256i *) (words + k + j));
+                                __m256i t = _mm256_and_si256 (_mm256_xor_si256 (_mm256_srl_epi64 (x, count), y), vector_mask);
+
+                                _mm256_storeu_si256 ((__m256i *) (words + k), _mm256_xor_si256 (x, _mm256_sll_epi64 (t, count)));
+                                _mm256_storeu_si256 ((__m256i *) (words + k + j), _mm256_xor_si256 (y, t));
+                        }
+                }
+        }
+
+        const __m256i mask_2 = _mm256_setr_epi64x (0x3333333333333333L, 0x3333333333333333L, 0, 0);
+        const __m256i mask_1 = _mm256_setr_epi64x (0x5555555555555555L, 0, 0x5555555555555555L, 0);
+
+        for (size_t k = 0; k < 64; k += 4) {
+                __m256i v = _mm256_loadu_si256 ((const __m256i *) (words + k));
+                __m256i t;
+
+                t = _mm256_and_si256 (_mm256_xor_si256 (_mm256_srli_epi64 (v, 2), _mm256_permute4x64_epi64 (v, 0x4e)), mask_2);
+                v = _mm256_xor_si256 (v, _mm256_xor_si256 (_mm256_slli_epi64 (t, 2), _mm256_permute4x64_epi64 (t, 0x4e)));
+
+                t = _mm256_and_si256 (_mm256_xor_si256 (_mm256_srli_epi64 (v, 1), _mm256_shuffle_epi32 (v, 0x4e)), mask_1);
+                v = _mm256_xor_si256 (v, _mm256_xor_si256 (_mm256_slli_epi64 (t, 1), _mm256_shuffle_epi32 (t, 0x4e)));
+
+                _mm256_storeu_si256 ((__m256i *) (words + k), v);
+        }
+}
+
+static const itty_bit_string_kernels_t itty_bit_string_avx2_kernels = {
+        .name = "avx2",
+        .level = ITTY_BIT_STRING_KERNEL_LEVEL_AVX2,
+        .exclusive_nor = itty_bit_string_avx2_exclusive_nor,
+        .exclusive_or = itty_bit_string_avx2_exclusive_or,
+        .combine = itty_bit_string_avx2_combine,
+        .mask = itty_bit_string_avx2_mask,
+        .pop_count = itty_bit_string_avx2_pop_count,
+        .exclusive_nor_pop_count = itty_bit_string_avx2_exclusive_nor_pop_count,
+        .exclusive_or_pop_count = itty_bit_string_avx2_exclusive_or_pop_count,
+        .mask_pop_count = itty_bit_string_avx2_mask_pop_count,
+        .pop_count_each_word = itty_bit_string_avx2_pop_count_each_word,
+        .funnel_shift = itty_bit_string_avx2_funnel_shift,
+        .transpose = itty_bit_string_avx2_transpose,
+        .exclusive_or_pop_count_tile = itty_bit_string_avx2_exclusive_or_pop_count_tile,
+};
+
+#define ITTY_DEFINE_AVX2_FIXED_WIDTH_KERNELS(width) \
+        ITTY_DEFINE_FIXED_WIDTH_KERNELS (avx2, "avx2", ITTY_BIT_STRING_KERNEL_LEVEL_AVX2, __attribute__ ((target ("avx2"))), __m256i, \
+                                         _mm256_loadu_si256, _mm256_storeu_si256, _mm256_add_epi64, \
+                                         _mm256_xor_si256 (_mm256_xor_si256 (x, y), _mm256_set1_epi32 (-1)), _mm256_xor_si256 (x, y), \
+                                         _mm256_or_si256 (x, y), _mm256_and_si256 (x, y), \
+                                         itty_bit_string_avx2_pop_count_each_word, itty_bit_string_avx2_funnel_shift, \
+                                         itty_bit_string_avx2_transpose, \
+                                         itty_bit_string_avx2_exclusive_or_pop_count_tile, width)
+
+ITTY_DEFINE_AVX2_FIXED_WIDTH_KERNELS (1)
+ITTY_DEFINE_AVX2_FIXED_WIDTH_KERNELS (2)
+ITTY_DEFINE_AVX2_FIXED_WIDTH_KERNELS (4)
+ITTY_DEFINE_AVX2_FIXED_WIDTH_KERNELS (8)
+ITTY_DEFINE_AVX2_FIXED_WIDTH_KERNELS (16)
+
+static inline __attribute__ ((target ("avx512f"))) __m512i
+itty_bit_string_avx512_pop_count_lanes (__m512i v)
+{
+        const __m512i m1 = _mm512_set1_epi64 (0x5555555555555555);
+        const __m512i m2 = _mm512_set1_epi64 (0x3333333333333333);
+        const __m512i m4 = _mm512_set1_epi64 (0x0f0f0f0f0f0f0f0f);
+
+        v = _mm512_sub_epi64 (v, _mm512_and_si512 (_mm512_srli_epi64 (v, 1), m1));
+        v = _mm512_add_epi64 (_mm512_and_si512 (v, m2), _mm512_and_si512 (_mm512_srli_epi64 (v, 2), m2));
+        v = _mm512_and_si512 (_mm512_add_epi64 (v, _mm512_srli_epi64 (v, 4)), m4);
+        v = _mm512_add_epi64 (v, _mm512_srli_epi64 (v, 8));
+        v = _mm512_add_epi64 (v, _mm512_srli_epi64 (v, 16));
+        v = _mm512_add_epi64 (v, _mm512_srli_epi64 (v, 32));
+
+        return _mm512_and_si512 (v, _mm512_set1_epi64 (0x7f));
+}
+
+static inline __attribute__ ((target ("avx512f"))) void
+itty_bit_string_avx512_carry_save_add (__m512i *high,
+                                       __m512i *low,
+                                       __m512i  a,
+                                       __m512i  b,
+                                       __m512i  c)
+{
+        *high = _mm512_ternarylogic_epi64 (a, b, c, 0xe8);
+        *low = _mm512_ternarylogic_epi64 (a, b, c, 0x96);
+}
+
+#define ITTY_DEFINE_AVX512_BINARY_KERNEL(name, expression) \
+        ITTY_DEFINE_VECTOR_BINARY_KERNEL (avx512, "avx512f", __m512i, _mm512_loadu_si512, _mm512_storeu_si512, name, expression)
+
+ITTY_DEFINE_AVX512_BINARY_KERNEL (exclusive_nor, _mm512_ternarylogic_epi64 (x, y, y, 0xc3))
+ITTY_DEFINE_AVX512_BINARY_KERNEL (exclusive_or, _mm512_xor_si512 (x, y))
+ITTY_DEFINE_AVX512_BINARY_KERNEL (combine, _mm512_or_si512 (x, y))
+ITTY_DEFINE_AVX512_BINARY_KERNEL (mask, _mm512_and_si512 (x, y))
+
+ITTY_DEFINE_HARLEY_SEAL_POP_COUNT_KERNEL (avx512, "avx512f", __m512i, _mm512_loadu_si512, _mm512_add_epi64, _mm512_slli_epi64)
+ITTY_DEFINE_VECTOR_POP_COUNT_EACH_WORD_KERNEL (avx512, "avx512f", __m512i, _mm512_loadu_si512, _mm512_storeu_si512)
+
+ITTY_DEFINE_VECTOR_FUNNEL_SHIFT_KERNEL (avx512, "avx512f", __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_or_si512, _mm512_sll_epi64, _mm512_srl_epi64)
+ITTY_DEFINE_VECTOR_EXCLUSIVE_OR_POP_COUNT_TILE_KERNEL (avx512, "avx512f", __m512i, _mm512_loadu_si512, _mm512_add_epi64, _mm512_set1_epi64, _mm512_xor_si512)
+
+#define ITTY_DEFINE_AVX512_BINARY_POP_COUNT_KERNEL(name, expression) \
+        ITTY_DEFINE_VECTOR_BINARY_POP_COUNT_KERNEL (avx512, "avx512f", __m512i, _mm512_loadu_si512, _mm512_add_epi64, name, expression)
+
+ITTY_DEFINE_AVX512_BINARY_POP_COUNT_KERNEL (exclusive_nor, _mm512_ternarylogic_epi64 (x, y, y, 0xc3))
+ITTY_DEFINE_AVX512_BINARY_POP_COUNT_KERNEL (exclusive_or, _mm512_xor_si512 (x, y))
+ITTY_DEFINE_AVX512_BINARY_POP_COUNT_KERNEL (mask, _mm512_and_si512 (x, y))
+
+static const itty_bit_string_kernels_t itty_bit_string_avx512_kernels = {
+        .name = "avx512",
+        .level = ITTY_BIT_STRING_KERNEL_LEVEL_AVX512,
+        .exclusive_nor = itty_bit_string_avx512_exclusive_nor,
+        .exclusive_or = itty_bit_string_avx512_exclusive_or,
+        .combine = itty_bit_string_avx512_combine,
+        .mask = itty_bit_string_avx512_mask,
+        .pop_count = itty_bit_string_avx512_pop_count,
+        .exclusive_nor_pop_count = itty_bit_string_avx512_exclusive_nor_pop_count,
+        .exclusive_or_pop_count = itty_bit_string_avx512_exclusive_or_pop_count,
+        .mask_pop_count = itty_bit_string_avx512_mask_pop_count,
+        .pop_count_each_word = itty_bit_string_avx512_pop_count_each_word,
+        .funnel_shift = itty_bit_string_avx512_funnel_shift,
+        .transpose = itty_bit_string_avx2_transpose,
+        .exclusive_or_pop_count_tile = itty_bit_string_avx512_exclusive_or_pop_count_tile,
+};
+
+#define ITTY_DEFINE_AVX512_FIXED_WIDTH_KERNELS(width) \
+        ITTY_DEFINE_FIXED_WIDTH_KERNELS (avx512, "avx512", ITTY_BIT_STRING_KERNEL_LEVEL_AVX512, __attribute__ ((target ("avx512f"))), __m512i, \
+                                         _mm512_loadu_si512, _mm512_storeu_si512, _mm512_add_epi64, \
+                                         _mm512_ternarylogic_epi64 (x, y, y, 0xc3), _mm512_xor_si512 (x, y), \
+                                         _mm512_or_si512 (x, y), _mm512_and_si512 (x, y), \
+                                         itty_bit_string_avx512_pop_count_each_word, itty_bit_string_avx512_funnel_shift, \
+                                         itty_bit_string_avx2_transpose, \
+                                         itty_bit_string_avx512_exclusive_or_pop_count_tile, width)
+
+ITTY_DEFINE_AVX512_FIXED_WIDTH_KERNELS (1)
+ITTY_DEFINE_AVX512_FIXED_WIDTH_KERNELS (2)
+ITTY_DEFINE_AVX512_FIXED_WIDTH_KERNELS (4)
+ITTY_DEFINE_AVX512_FIXED_WIDTH_KERNELS (8)
+ITTY_DEFINE_AVX512_FIXED_WIDTH_KERNELS (16)
+
+static inline __attribute__ ((target ("avx512f,avx512vpopcntdq"))) __m512i
+itty_bit_string_avx512_vpopcntdq_pop_count_lanes (__m512i v)
+{
+        return _mm512_popcnt_epi64 (v);
+}
+
+ITTY_DEFINE_VECTOR_POP_COUNT_KERNEL (avx512_vpopcntdq, "avx512f,avx512vpopcntdq", __m512i, _mm512_loadu_si512, _mm512_add_epi64)
+ITTY_DEFINE_VECTOR_POP_COUNT_EACH_WORD_KERNEL (avx512_vpopcntdq, "avx512f,avx512vpopcntdq", __m512i, _mm512_loadu_si512, _mm512_storeu_si512)
+ITTY_DEFINE_VECTOR_EXCLUSIVE_OR_POP_COUNT_TILE_KERNEL (avx512_vpopcntdq, "avx512f,avx512vpopcntdq", __m512i, _mm512_loadu_si512, _mm512_add_epi64, _mm512_set1_epi64, _mm512_xor_si512)
+
+#define ITTY_DEFINE_AVX512_VPOPCNTDQ_BINARY_POP_COUNT_KERNEL(name, expression) \
+        ITTY_DEFINE_VECTOR_BINARY_POP_COUNT_KERNEL (avx512_vpopcntdq, "avx512f,avx512vpopcntdq", __m512i, _mm512_loadu_si512, _mm512_add_epi64, name, expression)
+
+ITTY_DEFINE_AVX512_VPOPCNTDQ_BINARY_POP_COUNT_KERNEL (exclusive_nor, _mm512_ternarylogic_epi64 (x, y, y, 0xc3))
+ITTY_DEFINE_AVX512_VPOPCNTDQ_BINARY_POP_COUNT_KERNEL (exclusive_or, _mm512_xor_si512 (x, y))
+ITTY_DEFINE_AVX512_VPOPCNTDQ_BINARY_POP_COUNT_KERNEL (mask, _mm512_and_si512 (x, y))
+
+static const itty_bit_string_kernels_t itty_bit_string_avx512_vpopcntdq_kernels = {
+        .name = "avx512-vpopcntdq",
+        .level = ITTY_BIT_STRING_KERNEL_LEVEL_AVX512_VPOPCNTDQ,
+        .exclusive_nor = itty_bit_string_avx512_exclusive_nor,
+        .exclusive_or = itty_bit_string_avx512_exclusive_or,
+        .combine = itty_bit_string_avx512_combine,
+        .mask = itty_bit_string_avx512_mask,
+        .pop_count = itty_bit_string_avx512_vpopcntdq_pop_count,
+        .exclusive_nor_pop_count = itty_bit_string_avx512_vpopcntdq_exclusive_nor_pop_count,
+        .exclusive_or_pop_count = itty_bit_string_avx512_vpopcntdq_exclusive_or_pop_count,
+        .mask_pop_count = itty_bit_string_avx512_vpopcntdq_mask_pop_count,
+        .pop_count_each_word = itty_bit_string_avx512_vpopcntdq_pop_count_each_word,
+        .funnel_shift = itty_bit_string_avx512_funnel_shift,
+        .transpose = itty_bit_string_avx2_transpose,
+        .exclusive_or_pop_count_tile = itty_bit_string_avx512_vpopcntdq_exclusive_or_pop_count_tile,
+};
+
+#define ITTY_DEFINE_AVX512_VPOPCNTDQ_FIXED_WIDTH_KERNELS(width) \
+        ITTY_DEFINE_FIXED_WIDTH_KERNELS (avx512_vpopcntdq, "avx512-vpopcntdq", ITTY_BIT_STRING_KERNEL_LEVEL_AVX512_VPOPCNTDQ, __attribute__ ((target ("avx512f,avx512vpopcntdq"))), __m512i, \
+                                         _mm512_loadu_si512, _mm512_storeu_si512, _mm512_add_epi64, \
+                                         _mm512_ternarylogic_epi64 (x, y, y, 0xc3), _mm512_xor_si512 (x, y), \
+                                         _mm512_or_si512 (x, y), _mm512_and_si512 (x, y), \
+                                         itty_bit_string_avx512_vpopcntdq_pop_count_each_word, itty_bit_string_avx512_funnel_shift, \
+                                         itty_bit_string_avx2_transpose, \
+                                         itty_bit_string_avx512_vpopcntdq_exclusive_or_pop_count_tile, width)
+
+ITTY_DEFINE_AVX512_VPOPCNTDQ_FIXED_WIDTH_KERNELS (1)
+ITTY_DEFINE_AVX512_VPOPCNTDQ_FIXED_WIDTH_KERNELS (2)
+ITTY_DEFINE_AVX512_VPOPCNTDQ_FIXED_WIDTH_KERNELS (4)
+ITTY_DEFINE_AVX512_VPOPCNTDQ_FIXED_WIDTH_KERNELS (8)
+ITTY_DEFINE_AVX512_VPOPCNTDQ_FIXED_WIDTH_KERNELS (16)
+
+#endif
+
+#define ITTY_BIT_STRING_FIXED_WIDTH_KERNELS(level)                                      \
+        {                                                                               \
+                &itty_bit_string_##level##_kernels_1,                                   \
+                &itty_bit_string_##level##_kernels_2,                                   \
+                &itty_bit_string_##level##_kernels_4,                                   \
+                &itty_bit_string_##level##_kernels_8,                                   \
+                &itty_bit_string_##level##_kernels_16,                                  \
+        }
+
+/* Indexed by level, then by log2 of the width */
+static const itty_bit_string_kernels_t *itty_bit_string_fixed_width_kernels[ITTY_BIT_STRING_NUMBER_OF_KERNEL_LEVELS][ITTY_BIT_STRING_NUMBER_OF_FIXED_WIDTHS] = {
+        [ITTY_BIT_STRING_KERNEL_LEVEL_SCALAR] = ITTY_BIT_STRING_FIXED_WIDTH_KERNELS (scalar),
+#ifdef ITTY_BIT_STRING_KERNELS_X86
+        [ITTY_BIT_STRING_KERNEL_LEVEL_SSE2] = ITTY_BIT_STRING_FIXED_WIDTH_KERNELS (sse2),
+        [ITTY_BIT_STRING_KERNEL_LEVEL_AVX2] = ITTY_BIT_STRING_FIXED_WIDTH_KERNELS (avx2),
+        [ITTY_BIT_STRING_KERNEL_LEVEL_AVX512] = ITTY_BIT_STRING_FIXED_WIDTH_KERNELS (avx512),
+        [ITTY_BIT_STRING_KERNEL_LEVEL_AVX512_VPOPCNTDQ] = ITTY_BIT_STRING_FIXED_WIDTH_KERNELS (avx512_vpopcntdq),
+#endif
+};
+
+static pthread_once_t itty_bit_string_kernels_once = PTHREAD_ONCE_INIT;
+static const itty_bit_string_kernels_t *itty_bit_string_kernels = &itty_bit_string_scalar_kernels;
+
+const itty_bit_string_kernels_t *
+itty_bit_string_kernels_get_for_level (itty_bit_string_kernel_level_t level)
+{
+        switch (level) {
+        case ITTY_BIT_STRING_KERNEL_LEVEL_SCALAR:
+                return &itty_bit_string_scalar_kernels;
+#ifdef ITTY_BIT_STRING_KERNELS_X86
+        case ITTY_BIT_STRING_KERNEL_LEVEL_SSE2:
+                __builtin_cpu_init ();
+                if (__builtin_cpu_supports ("sse2"))
+                        return &itty_bit_string_sse2_kernels;
+                break;
+        case ITTY_BIT_STRING_KERNEL_LEVEL_AVX2:
+                __builtin_cpu_init ();
+                if (__builtin_cpu_supports ("avx2"))
+                        return &itty_bit_string_avx2_kernels;
+                break;
+        case ITTY_BIT_STRING_KERNEL_LEVEL_AVX512:
+                __builtin_cpu_init ();
+                if (__builtin_cpu_supports ("avx512f"))
+                        return &itty_bit_string_avx512_kernels;
+                break;
+        case ITTY_BIT_STRING_KERNEL_LEVEL_AVX512_VPOPCNTDQ:
+                __builtin_cpu_init ();
+                if (__builtin_cpu_supports ("avx512f") && __builtin_cpu_supports ("avx512vpopcntdq"))
+                        return &itty_bit_string_avx512_vpopcntdq_kernels;
+                break;
+#endif
+        default:
+                break;
+        }
+
+        return NULL;
+}
+
+static void
+itty_bit_string_kernels_init (void)
+{
+        for (int level = ITTY_BIT_STRING_NUMBER_OF_KERNEL_LEVELS - 1; level >= 0; level--) {
+                const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get_for_level (level);
+
+                if (kernels != NULL) {
+                        itty_bit_string_kernels = kernels;
+                        break;
+                }
+        }
+}
+
+const itty_bit_string_kernels_t *
+itty_bit_string_kernels_get (void)
+{
+        pthread_once (&itty_bit_string_kernels_once, itty_bit_string_kernels_init);
+        return itty_bit_string_kernels;
+}
+
+static bool
+itty_bit_string_kernels_has_fixed_width (size_t number_of_words)
+{
+        if (number_of_words == 0 || number_of_words > ITTY_BIT_STRING_KERNELS_MAXIMUM_FIXED_WIDTH)
+                return false;
+
+        return (number_of_words & (number_of_words - 1)) == 0;
+}
+
+const itty_bit_string_kernels_t *
+itty_bit_string_kernels_get_for_level_and_width (itty_bit_string_kernel_level_t level,
+                                                 size_t                         number_of_words)
+{
+        if (itty_bit_string_kernels_get_for_level (level) == NULL)
+                return NULL;
+
+        if (!itty_bit_string_kernels_has_fixed_width (number_of_words))
+                return NULL;
+
+        return itty_bit_string_fixed_width_kernels[level][__builtin_ctzl (number_of_words)];
+}
+
+const itty_bit_string_kernels_t *
+itty_bit_string_kernels_get_for_width (size_t number_of_words)
+{
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+
+        if (!itty_bit_string_kernels_has_fixed_width (number_of_words))
+                return kernels;
+
+        return itty_bit_string_fixed_width_kernels[kernels->level][__builtin_ctzl (number_of_words)];
+}
@@ -2,10 +2,13 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "itty-arena.h"
 #include "itty-bit-string.h"
 
 struct itty_bit_string_list_t {
         itty_bit_string_t **bit_strings;
         size_t              count;
+        size_t              capacity;
         size_t              max_number_of_words;
+        itty_arena_t       *arena;
 };
@@ -2,6 +2,7 @@
 #include "itty-bit-string-list-private.h"
 #include "itty-bit-string.h"
 #include "itty-bit-string-private.h"
+#include "itty-bit-string-kernels-private.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,9 +10,18 @@
 itty_bit_string_list_t *
 itty_bit_string_list_new (void)
 {
-        itty_bit_string_list_t *list = malloc (sizeof (itty_bit_string_list_t));
+        itty_arena_t *arena = itty_arena_get_thread_default ();
+        itty_bit_string_list_t *list;
+
+        if (arena != NULL)
+                list = itty_arena_allocate (arena, sizeof (itty_bit_string_list_t));
+        else
+                list = malloc (sizeof (itty_bit_string_list_t));
+
+        list->arena = arena;
         list->bit_strings = NULL;
         list->count = 0;
+        list->capacity = 0;
         list->max_number_of_words = 0;
         return list;
 }
@@ -25,6 +35,10 @@ itty_bit_string_list_free (itty_bit_string_list_t *list)
         for (size_t i = 0; i < list->count; i++) {
                 itty_bit_string_free (list->bit_strings[i]);
         }
+
+        if (list->arena != NULL)
+                return;
+
         free (list->bit_strings);
         free (list);
 }
@@ -33,8 +47,20 @@ void
 itty_bit_string_list_append (itty_bit_string_list_t *list,
                              itty_bit_string_t      *bit_string)
 {
-        list->bit_strings = realloc (list->bit_strings,
-                                    (list->count + 1) * sizeof (itty_bit_string_t *));
+        if (list->count == list->capacity) {
+                size_t capacity = list->capacity > 0 ? list->capacity * 2 : 4;
+
+                if (list->arena != NULL) {
+                        itty_bit_string_t **bit_strings = itty_arena_allocate (list->arena, capacity * sizeof (itty_bit_string_t *));
+                        if (list->count > 0)
+                                memcpy (bit_strings, list->bit_strings, list->count * sizeof (itty_bit_string_t *));
+                        list->bit_strings = bit_strings;
+                } else {
+                        list->bit_strings = realloc (list->bit_strings, capacity * sizeof (itty_bit_string_t *));
+                }
+                list->capacity = capacity;
+        }
+
         list->bit_strings[list->count] = bit_string;
         list->count++;
 
@@ -83,6 +109,87 @@ itty_bit_string_list_exclusive_or (itty_bit_string_list_t *list_a,
         return result_list;
 }
 
+#define ITTY_BIT_STRING_LIST_MINIMUM_WORDS_PER_TASK (64 * 1024)
+
+static size_t
+itty_bit_string_list_get_minimum_items_per_task (size_t number_of_words)
+{
+        if (number_of_words == 0 || number_of_words >= ITTY_BIT_STRING_LIST_MINIMUM_WORDS_PER_TASK)
+                return 1;
+
+        return ITTY_BIT_STRING_LIST_MINIMUM_WORDS_PER_TASK / number_of_words;
+}
+
+typedef struct {
+        itty_bit_string_list_t *list_a;
+        itty_bit_string_list_t *list_b;
+        itty_bit_string_list_t *result_list;
+} itty_bit_string_list_exclusive_or_job_t;
+
+static inline bool
+itty_bit_string_list_has_sparse_operands (itty_bit_string_t *a,
+                                          itty_bit_string_t *b)
+{
+        return a->sparse != NULL || b->sparse != NULL;
+}
+
+static void
+itty_bit_string_list_exclusive_or_range (void   *data,
+                                         size_t  start,
+                                         size_t  end)
+{
+        itty_bit_string_list_exclusive_or_job_t *job = data;
+
+        for (size_t i = start; i < end; i++) {
+                itty_bit_string_t *a = job->list_a->bit_strings[i];
+                itty_bit_string_t *b = job->list_b->bit_strings[i];
+
+                if (itty_bit_string_list_has_sparse_operands (a, b))
+                        continue;
+
+                itty_bit_string_exclusive_or_into (job->result_list->bit_strings[i], a, b);
+        }
+}
+
+/* Workers must not allocate, so results, and those with sparse operands, are made up front */
+itty_bit_string_list_t *
+itty_bit_string_list_exclusive_or_with_manager (itty_bit_string_list_t *list_a,
+                                                itty_bit_string_list_t *list_b,
+                                                itty_manager_t         *manager)
+{
+        if (!list_a || !list_b) {
+                return NULL;
+        }
+
+        size_t min_count = (list_a->count < list_b->count) ? list_a->count : list_b->count;
+        size_t max_number_of_words = list_a->max_number_of_words > list_b->max_number_of_words ? list_a->max_number_of_words : list_b->max_number_of_words;
+
+        itty_bit_string_list_t *result_list = itty_bit_string_list_new ();
+
+        for (size_t i = 0; i < min_count; i++) {
+                itty_bit_string_t *a = list_a->bit_strings[i];
+                itty_bit_string_t *b = list_b->bit_strings[i];
+                itty_bit_string_t *result;
+
+                if (a->aligned && b->aligned)
+                        result = itty_bit_string_new_aligned (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                else
+                        result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+                itty_bit_string_reserve (result, a->number_of_words > b->number_of_words ? a->number_of_words : b->number_of_words);
+                if (itty_bit_string_list_has_sparse_operands (a, b))
+                        itty_bit_string_exclusive_or_into (result, a, b);
+                itty_bit_string_list_append (result_list, result);
+        }
+
+        itty_bit_string_list_exclusive_or_job_t job = { list_a, list_b, result_list };
+
+        itty_manager_run_in_parallel (manager, min_count, itty_bit_string_list_get_minimum_items_per_task (max_number_of_words),
+                                      itty_bit_string_list_exclusive_or_range, &job);
+
+        return result_list;
+}
+
 itty_bit_string_t *
 itty_bit_string_list_fetch (itty_bit_string_list_t *list,
                             size_t                  index)
@@ -93,107 +200,588 @@ itty_bit_string_list_fetch (itty_bit_string_list_t *list,
     return list->bit_strings[index];
 }
 
-itty_bit_string_t *
-itty_bit_string_list_condense (itty_bit_string_list_t *list)
+#define ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE 64
+
+/* Counts are bit sliced: plane p of word i's counts lives at counters[p * BLOCK_SIZE + i] */
+static inline void
+itty_bit_string_list_add_carry (size_t *counters,
+                                size_t  number_of_planes,
+                                size_t  index,
+                                size_t  plane,
+                                size_t  carry)
 {
-        if (list->count == 0) {
-                return NULL;
+        for (; carry != 0 && plane < number_of_planes; plane++) {
+                size_t *counter = &counters[plane * ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE + index];
+                size_t next_carry = *counter & carry;
+
+                *counter ^= carry;
+                carry = next_carry;
         }
+}
 
-        itty_bit_string_list_t *transposed_list = itty_bit_string_list_transpose (list);
-        if (!transposed_list) {
-                return NULL;
+static inline size_t
+itty_bit_string_list_get_word (itty_bit_string_t *bit_string,
+                               size_t             word_index)
+{
+        if (word_index >= bit_string->number_of_words)
+                return 0;
+
+        return itty_bit_string_get_word (bit_string, word_index);
+}
+
+static inline size_t
+itty_bit_string_list_get_counts_at_least (const size_t *counters,
+                                          size_t        number_of_planes,
+                                          size_t        index,
+                                          size_t        threshold)
+{
+        size_t greater = 0;
+        size_t equal = ~0UL;
+
+        for (size_t plane = number_of_planes; plane-- > 0;) {
+                size_t counter = counters[plane * ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE + index];
+
+                if ((threshold >> plane) & 1) {
+                        equal &= counter;
+                } else {
+                        greater |= equal & counter;
+                        equal &= ~counter;
+                }
         }
 
-        size_t max_number_of_words = transposed_list->max_number_of_words;
-        itty_bit_string_t *condensed_bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
-        condensed_bit_string->words = calloc (max_number_of_words, sizeof (size_t));
-        condensed_bit_string->number_of_words = max_number_of_words;
+        return greater | equal;
+}
 
-        size_t majority_threshold = list->count / 2 + 1;
+static void
+itty_bit_string_list_condense_block (itty_bit_string_t **bit_strings,
+                                     size_t              count,
+                                     size_t             *counters,
+                                     size_t              number_of_planes,
+                                     size_t              threshold,
+                                     size_t              block_start,
+                                     size_t              block_size,
+                                     size_t             *words)
+{
+        size_t i;
 
-        for (size_t i = 0; i < transposed_list->count; i++) {
-                itty_bit_string_t *bit_string = transposed_list->bit_strings[i];
-                size_t pop_count = itty_bit_string_get_pop_count(bit_string);
+        memset (counters, 0, number_of_planes * ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE * sizeof (size_t));
 
-                if (pop_count >= majority_threshold) {
-                        for (size_t word_index = 0; word_index < bit_string->number_of_words; word_index++) {
-                                condensed_bit_string->words[word_index] |= ((size_t) 1 << (transposed_list->count - 1 - i));
-                        }
+        for (i = 0; i + 1 < count; i += 2) {
+                itty_bit_string_t *a = bit_strings[i];
+                itty_bit_string_t *b = bit_strings[i + 1];
+
+                for (size_t j = 0; j < block_size; j++) {
+                        size_t a_word = itty_bit_string_list_get_word (a, block_start + j);
+                        size_t b_word = itty_bit_string_list_get_word (b, block_start + j);
+                        size_t ones = counters[j];
+                        size_t sum = ones ^ a_word;
+
+                        counters[j] = sum ^ b_word;
+                        itty_bit_string_list_add_carry (counters, number_of_planes, j, 1, (ones & a_word) | (sum & b_word));
                 }
         }
 
-        itty_bit_string_list_free (transposed_list);
+        if (i < count) {
+                for (size_t j = 0; j < block_size; j++)
+                        itty_bit_string_list_add_carry (counters, number_of_planes, j, 0, itty_bit_string_list_get_word (bit_strings[i], block_start + j));
+        }
+
+        for (size_t j = 0; j < block_size; j++)
+                words[j] = itty_bit_string_list_get_counts_at_least (counters, number_of_planes, j, threshold);
+}
+
+typedef struct {
+        itty_bit_string_list_t *list;
+        itty_bit_string_t      *condensed_bit_string;
+        size_t                  number_of_planes;
+        size_t                  threshold;
+} itty_bit_string_list_condense_job_t;
+
+static void
+itty_bit_string_list_condense_range (void   *data,
+                                     size_t  start,
+                                     size_t  end)
+{
+        itty_bit_string_list_condense_job_t *job = data;
+        itty_bit_string_list_t *list = job->list;
+        size_t number_of_words = list->max_number_of_words;
+        size_t number_of_planes = job->number_of_planes;
+        size_t counters[ITTY_BIT_STRING_WORD_SIZE_IN_BITS * ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE];
+
+        for (size_t block_start = start * ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE; block_start < end * ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE; block_start += ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE) {
+                size_t block_size = number_of_words - block_start;
+
+                if (block_size > ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE)
+                        block_size = ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE;
+
+                itty_bit_string_list_condense_block (list->bit_strings, list->count, counters, number_of_planes, job->threshold,
+                                                     block_start, block_size, job->condensed_bit_string->words + block_start);
+        }
+}
+
+static itty_bit_string_t *
+itty_bit_string_list_condense_full (itty_bit_string_list_t *list,
+                                    size_t                  threshold,
+                                    itty_manager_t         *manager)
+{
+        if (list->count == 0) {
+                return NULL;
+        }
+
+        size_t number_of_words = list->max_number_of_words;
+        size_t number_of_blocks = (number_of_words + ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE - 1) / ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE;
+        size_t largest_count = list->count > threshold ? list->count : threshold;
+
+        itty_bit_string_t *condensed_bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_append_zeros (condensed_bit_string, number_of_words);
+
+        itty_bit_string_list_condense_job_t job = {
+                list,
+                condensed_bit_string,
+                ITTY_BIT_STRING_WORD_SIZE_IN_BITS - __builtin_clzl (largest_count),
+                threshold
+        };
+
+        if (manager == NULL) {
+                itty_bit_string_list_condense_range (&job, 0, number_of_blocks);
+        } else {
+                size_t minimum_blocks_per_task = itty_bit_string_list_get_minimum_items_per_task (list->count * ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE);
+
+                itty_manager_run_in_parallel (manager, number_of_blocks, minimum_blocks_per_task,
+                                              itty_bit_string_list_condense_range, &job);
+        }
 
         return condensed_bit_string;
 }
 
-itty_bit_string_list_t *
-itty_bit_string_list_transpose (itty_bit_string_list_t *list)
+itty_bit_string_t *
+itty_bit_string_list_condense_with_threshold (itty_bit_string_list_t *list,
+                                              size_t                  threshold)
+{
+        return itty_bit_string_list_condense_full (list, threshold, NULL);
+}
+
+itty_bit_string_t *
+itty_bit_string_list_condense (itty_bit_string_list_t *list)
+{
+        return itty_bit_string_list_condense_full (list, list->count / 2 + 1, NULL);
+}
+
+itty_bit_string_t *
+itty_bit_string_list_condense_with_manager (itty_bit_string_list_t *list,
+                                            itty_manager_t         *manager)
+{
+        return itty_bit_string_list_condense_full (list, list->count / 2 + 1, manager);
+}
+
+typedef struct {
+        itty_bit_string_list_t *list;
+        itty_bit_string_t      *rows;
+        size_t                  bit_length;
+} itty_bit_string_list_transpose_job_t;
+
+static void
+itty_bit_string_list_transpose_range (void   *data,
+                                      size_t  start,
+                                      size_t  end)
+{
+        itty_bit_string_list_transpose_job_t *job = data;
+        itty_bit_string_list_t *list = job->list;
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+        size_t bit_length = job->bit_length;
+        size_t number_of_source_words = (bit_length + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t number_of_words = (list->count + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t tile[ITTY_BIT_STRING_WORD_SIZE_IN_BITS];
+
+        for (size_t word_index = start; word_index < end; word_index++) {
+                size_t first_string = word_index * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                size_t number_of_strings = list->count - first_string;
+
+                if (number_of_strings > ITTY_BIT_STRING_WORD_SIZE_IN_BITS)
+                        number_of_strings = ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+                for (size_t source_word_index = 0; source_word_index < number_of_source_words; source_word_index++) {
+                        size_t first_bit = source_word_index * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                        size_t number_of_bits = bit_length - first_bit;
+
+                        if (number_of_bits > ITTY_BIT_STRING_WORD_SIZE_IN_BITS)
+                                number_of_bits = ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+                        for (size_t i = 0; i < number_of_strings; i++)
+                                tile[i] = itty_bit_string_list_get_word (list->bit_strings[first_string + i], source_word_index);
+                        memset (tile + number_of_strings, 0, (ITTY_BIT_STRING_WORD_SIZE_IN_BITS - number_of_strings) * sizeof (size_t));
+
+                        kernels->transpose (tile);
+
+                        for (size_t bit = 0; bit < number_of_bits; bit++) {
+                                size_t row = bit_length - 1 - (first_bit + bit);
+                                job->rows->words[row * number_of_words + word_index] = tile[bit];
+                        }
+                }
+        }
+}
+
+/* Row r holds bit bit_length - 1 - r of every string, string i at bit i */
+static itty_bit_string_list_t *
+itty_bit_string_list_transpose_full (itty_bit_string_list_t *list,
+                                     itty_manager_t         *manager)
 {
         if (!list || list->count == 0) {
                 return NULL;
         }
 
         size_t bit_length = itty_bit_string_list_get_bit_length (list);
-        size_t number_of_words = (bit_length + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t number_of_source_words = (bit_length + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t number_of_words = (list->count + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
 
         itty_bit_string_list_t *transposed_list = itty_bit_string_list_new ();
 
-        for (size_t bit_position = bit_length; bit_position > 0; bit_position--) {
-                itty_bit_string_t *transposed_bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
-                itty_bit_string_append_zeros (transposed_bit_string, number_of_words);
+        if (bit_length == 0)
+                return transposed_list;
 
-                itty_bit_string_list_iterator_t list_iterator;
-                itty_bit_string_list_iterator_init (list, &list_iterator);
-                itty_bit_string_t *bit_string;
-                size_t string_index = 0;
+        itty_bit_string_t *rows = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_reserve (rows, bit_length * number_of_words);
+        rows->number_of_words = bit_length * number_of_words;
 
-                while (itty_bit_string_list_iterator_next (&list_iterator, &bit_string)) {
-                        itty_bit_string_iterator_t bit_string_iterator;
-                        itty_bit_string_iterator_init_at_word_offset (bit_string, &bit_string_iterator, (bit_position - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+        itty_bit_string_list_transpose_job_t job = { list, rows, bit_length };
 
-                        size_t word;
-                        if (itty_bit_string_iterator_next (&bit_string_iterator, &word)) {
-                                size_t bit_in_word = (bit_position - 1) % ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
-                                bool bit_value = (word & (1UL << bit_in_word)) != 0;
-                                itty_bit_string_set_bit (transposed_bit_string, string_index, bit_value);
-                        }
-                        string_index++;
-                }
-                itty_bit_string_list_append (transposed_list, transposed_bit_string);
+        if (manager == NULL) {
+                itty_bit_string_list_transpose_range (&job, 0, number_of_words);
+        } else {
+                size_t minimum_columns_per_task = itty_bit_string_list_get_minimum_items_per_task (number_of_source_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+
+                itty_manager_run_in_parallel (manager, number_of_words, minimum_columns_per_task,
+                                              itty_bit_string_list_transpose_range, &job);
         }
+
+        for (size_t row = 0; row < bit_length; row++)
+                itty_bit_string_list_append (transposed_list, itty_bit_string_new_view (rows, row * number_of_words, number_of_words));
+
+        itty_bit_string_unref (rows);
+
         return transposed_list;
 }
 
+itty_bit_string_list_t *
+itty_bit_string_list_transpose (itty_bit_string_list_t *list)
+{
+        return itty_bit_string_list_transpose_full (list, NULL);
+}
+
+itty_bit_string_list_t *
+itty_bit_string_list_transpose_with_manager (itty_bit_string_list_t *list,
+                                             itty_manager_t         *manager)
+{
+        return itty_bit_string_list_transpose_full (list, manager);
+}
+
 size_t
 itty_bit_string_list_get_max_number_of_words (itty_bit_string_list_t *list)
 {
         return list->max_number_of_words;
 }
 
-char *
-itty_bit_string_list_present (itty_bit_string_list_t                *bit_string_list,
-                              itty_bit_string_presentation_format_t  format)
+#define ITTY_BIT_STRING_LIST_POP_COUNT_BATCH_SIZE 64
+#define ITTY_BIT_STRING_LIST_MINIMUM_POP_COUNTS_PER_TASK 4096
+
+typedef struct {
+        itty_bit_string_list_t *list;
+        size_t                 *pop_counts;
+        size_t                  first_index;
+} itty_bit_string_list_pop_count_job_t;
+
+static void
+itty_bit_string_list_count_range (void   *data,
+                                  size_t  start,
+                                  size_t  end)
 {
-        size_t buffer_size = 0;
-        size_t buffer_used = 0;
-        char *list_representation = NULL;
-        size_t max_length = 0;
+        itty_bit_string_list_pop_count_job_t *job = data;
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+        size_t batch_words[ITTY_BIT_STRING_LIST_POP_COUNT_BATCH_SIZE];
+        size_t batch_pop_counts[ITTY_BIT_STRING_LIST_POP_COUNT_BATCH_SIZE];
+        size_t batch_indices[ITTY_BIT_STRING_LIST_POP_COUNT_BATCH_SIZE];
+        size_t batch_size = 0;
 
-        bool is_display_format = (format == ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY ||
-                                  format == ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY);
+        for (size_t i = start; i < end; i++) {
+                itty_bit_string_t *bit_string = job->list->bit_strings[i];
 
-        for (size_t i = 0; i < bit_string_list->count; i++) {
-                char *bit_string_representation = itty_bit_string_present (bit_string_list->bit_strings[i], format);
-                if (bit_string_representation) {
-                        size_t length = strlen (bit_string_representation);
-                        if (length > max_length) {
-                                max_length = length;
+                if (bit_string->pop_count_computed) {
+                        job->pop_counts[i - job->first_index] = bit_string->pop_count;
+                } else if (bit_string->number_of_words == 1) {
+                        batch_words[batch_size] = bit_string->words[0];
+                        batch_indices[batch_size] = i;
+                        batch_size++;
+                } else {
+                        const itty_bit_string_kernels_t *fixed_width_kernels = itty_bit_string_kernels_get_for_width (bit_string->number_of_words);
+                        job->pop_counts[i - job->first_index] = fixed_width_kernels->pop_count (bit_string->words, bit_string->number_of_words);
+                }
+
+                if (batch_size == ITTY_BIT_STRING_LIST_POP_COUNT_BATCH_SIZE || (i + 1 == end && batch_size > 0)) {
+                        kernels->pop_count_each_word (batch_pop_counts, batch_words, batch_size);
+                        for (size_t j = 0; j < batch_size; j++)
+                                job->pop_counts[batch_indices[j] - job->first_index] = batch_pop_counts[j];
+                        batch_size = 0;
+                }
+        }
+}
+
+void
+itty_bit_string_list_get_pop_counts (itty_bit_string_list_t *list,
+                                     size_t                 *pop_counts)
+{
+        itty_bit_string_list_pop_count_job_t job = { list, pop_counts, 0 };
+
+        itty_bit_string_list_count_range (&job, 0, list->count);
+}
+
+void
+itty_bit_string_list_get_pop_counts_with_manager (itty_bit_string_list_t *list,
+                                                  size_t                 *pop_counts,
+                                                  itty_manager_t         *manager)
+{
+        itty_bit_string_list_pop_count_job_t job = { list, pop_counts, 0 };
+
+        itty_manager_run_in_parallel (manager, list->count, ITTY_BIT_STRING_LIST_MINIMUM_POP_COUNTS_PER_TASK,
+                                      itty_bit_string_list_count_range, &job);
+}
+
+#define ITTY_BIT_STRING_LIST_SIMILARITY_BLOCK_WORDS (32 * 1024)
+
+typedef struct {
+        itty_bit_string_list_t *list_a;
+        itty_bit_string_list_t *list_b;
+        const size_t           *rows;
+        const size_t           *columns;
+        size_t                  number_of_words;
+        uint32_t               *similarities;
+        size_t                  first_row;
+} itty_bit_string_list_similarity_job_t;
+
+static itty_bit_string_t *
+itty_bit_string_list_pack_rows (itty_bit_string_list_t *list,
+                                size_t                  number_of_words)
+{
+        size_t number_of_tiles = (list->count + ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS - 1) / ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS;
+        size_t number_of_packed_words = number_of_tiles * ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * number_of_words;
+        itty_bit_string_t *packed = itty_bit_string_new_aligned (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+        itty_bit_string_reserve (packed, number_of_packed_words);
+        packed->number_of_words = number_of_packed_words;
+        memset (packed->words, 0, number_of_packed_words * sizeof (size_t));
+
+        for (size_t i = 0; i < list->count; i++) {
+                itty_bit_string_t *bit_string = list->bit_strings[i];
+
+                itty_bit_string_copy_words (bit_string, packed->words + i * number_of_words, bit_string->number_of_words);
+        }
+
+        return packed;
+}
+
+/* Panels interleave their columns word by word, the way the tile kernel reads them */
+static itty_bit_string_t *
+itty_bit_string_list_pack_columns (itty_bit_string_list_t *list,
+                                   size_t                  number_of_words)
+{
+        size_t number_of_panels = (list->count + ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS - 1) / ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS;
+        size_t panel_size = number_of_words * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS;
+        itty_bit_string_t *packed = itty_bit_string_new_aligned (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+        itty_bit_string_reserve (packed, number_of_panels * panel_size);
+        packed->number_of_words = number_of_panels * panel_size;
+        memset (packed->words, 0, number_of_panels * panel_size * sizeof (size_t));
+
+        for (size_t i = 0; i < list->count; i++) {
+                itty_bit_string_t *bit_string = list->bit_strings[i];
+                size_t *panel = packed->words + (i / ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS) * panel_size;
+                size_t column = i % ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS;
+
+                for (size_t k = 0; k < bit_string->number_of_words; k++)
+                        panel[k * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS + column] = itty_bit_string_get_word (bit_string, k);
+        }
+
+        return packed;
+}
+
+static void
+itty_bit_string_list_evaluate_similarities_range (void   *data,
+                                                  size_t  start,
+                                                  size_t  end)
+{
+        itty_bit_string_list_similarity_job_t *job = data;
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+        size_t number_of_words = job->number_of_words;
+        size_t number_of_rows = job->list_a->count;
+        size_t number_of_columns = job->list_b->count;
+        size_t number_of_panels = (number_of_columns + ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS - 1) / ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS;
+        size_t panel_size = number_of_words * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS;
+        size_t panels_per_block = ITTY_BIT_STRING_LIST_SIMILARITY_BLOCK_WORDS / panel_size;
+        uint32_t tile[ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS];
+
+        if (panels_per_block == 0)
+                panels_per_block = 1;
+
+        for (size_t first_panel = 0; first_panel < number_of_panels; first_panel += panels_per_block) {
+                size_t last_panel = first_panel + panels_per_block;
+
+                if (last_panel > number_of_panels)
+                        last_panel = number_of_panels;
+
+                for (size_t row_tile = start; row_tile < end; row_tile++) {
+                        const size_t *rows = job->rows + row_tile * ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * number_of_words;
+
+                        for (size_t panel = first_panel; panel < last_panel; panel++) {
+                                kernels->exclusive_or_pop_count_tile (tile, rows, job->columns + panel * panel_size, number_of_words);
+
+                                for (size_t i = 0; i < ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS; i++) {
+                                        size_t row = row_tile * ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS + i;
+
+                                        if (row >= number_of_rows)
+                                                break;
+
+                                        size_t row_number_of_words = job->list_a->bit_strings[row]->number_of_words;
+
+                                        for (size_t j = 0; j < ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS; j++) {
+                                                size_t column = panel * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS + j;
+
+                                                if (column >= number_of_columns)
+                                                        break;
+
+                                                size_t column_number_of_words = job->list_b->bit_strings[column]->number_of_words;
+                                                size_t max_number_of_words = row_number_of_words > column_number_of_words ? row_number_of_words : column_number_of_words;
+
+                                                job->similarities[(row - job->first_row) * number_of_columns + column] = max_number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS - tile[i * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS + j];
+                                        }
+                                }
                         }
-                        free (bit_string_representation);
                 }
         }
+}
+
+/* Zero extending to the widest element leaves every distance unchanged */
+static void
+itty_bit_string_list_evaluate_similarities_full (itty_bit_string_list_t *list_a,
+                                                 itty_bit_string_list_t *list_b,
+                                                 uint32_t               *similarities,
+                                                 itty_manager_t         *manager)
+{
+        if (!list_a || !list_b || list_a->count == 0 || list_b->count == 0) {
+                return;
+        }
+
+        size_t number_of_words = 0;
+
+        for (size_t i = 0; i < list_a->count; i++) {
+                if (list_a->bit_strings[i]->number_of_words > number_of_words)
+                        number_of_words = list_a->bit_strings[i]->number_of_words;
+        }
+
+        for (size_t i = 0; i < list_b->count; i++) {
+                if (list_b->bit_strings[i]->number_of_words > number_of_words)
+                        number_of_words = list_b->bit_strings[i]->number_of_words;
+        }
+
+        if (number_of_words == 0) {
+                memset (similarities, 0, list_a->count * list_b->count * sizeof (uint32_t));
+                return;
+        }
+
+        itty_bit_string_t *rows = itty_bit_string_list_pack_rows (list_a, number_of_words);
+        itty_bit_string_t *columns = itty_bit_string_list_pack_columns (list_b, number_of_words);
+        size_t number_of_row_tiles = (list_a->count + ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS - 1) / ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS;
+
+        itty_bit_string_list_similarity_job_t job = { list_a, list_b, rows->words, columns->words, number_of_words, similarities, 0 };
+
+        if (manager == NULL) {
+                itty_bit_string_list_evaluate_similarities_range (&job, 0, number_of_row_tiles);
+        } else {
+                size_t minimum_row_tiles_per_task = itty_bit_string_list_get_minimum_items_per_task (ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * number_of_words * list_b->count);
+
+                itty_manager_run_in_parallel (manager, number_of_row_tiles, minimum_row_tiles_per_task,
+                                              itty_bit_string_list_evaluate_similarities_range, &job);
+        }
+
+        itty_bit_string_unref (rows);
+        itty_bit_string_unref (columns);
+}
+
+void
+itty_bit_string_list_evaluate_similarities (itty_bit_string_list_t *list_a,
+                                            itty_bit_string_list_t *list_b,
+                                            uint32_t               *similarities)
+{
+        itty_bit_string_list_evaluate_similarities_full (list_a, list_b, similarities, NULL);
+}
+
+void
+itty_bit_string_list_evaluate_similarities_with_manager (itty_bit_string_list_t *list_a,
+                                                         itty_bit_string_list_t *list_b,
+                                                         uint32_t               *similarities,
+                                                         itty_manager_t         *manager)
+{
+        itty_bit_string_list_evaluate_similarities_full (list_a, list_b, similarities, manager);
+}
+
+static size_t *
+itty_bit_string_list_get_presentation_lengths (itty_bit_string_list_t                *bit_string_list,
+                                               itty_bit_string_presentation_format_t  format,
+                                               size_t                                *max_length)
+{
+        size_t *lengths = malloc ((bit_string_list->count > 0 ? bit_string_list->count : 1) * sizeof (size_t));
+
+        *max_length = 0;
+
+        for (size_t i = 0; i < bit_string_list->count; i++) {
+                lengths[i] = itty_bit_string_get_presentation_length (bit_string_list->bit_strings[i], format);
+                if (lengths[i] > *max_length)
+                        *max_length = lengths[i];
+        }
+
+        return lengths;
+}
+
+static bool
+itty_bit_string_list_is_display_format (itty_bit_string_presentation_format_t format)
+{
+        return format == ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY ||
+               format == ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY;
+}
+
+static size_t
+itty_bit_string_list_write_line (itty_bit_string_t                     *bit_string,
+                                 itty_bit_string_presentation_format_t  format,
+                                 bool                                   is_display_format,
+                                 size_t                                 length,
+                                 size_t                                 max_length,
+                                 char                                  *line)
+{
+        size_t line_length = 0;
+
+        if (is_display_format) {
+                memcpy (line, "\t\t", strlen ("\t\t"));
+                line_length += strlen ("\t\t");
+                memset (line + line_length, ' ', max_length - length);
+                line_length += max_length - length;
+        }
+
+        itty_bit_string_present_to_buffer (bit_string, format, line + line_length, length + 1);
+        line_length += length;
+
+        if (is_display_format)
+                line[line_length++] = '\n';
+
+        return line_length;
+}
+
+char *
+itty_bit_string_list_present (itty_bit_string_list_t                *bit_string_list,
+                              itty_bit_string_presentation_format_t  format)
+{
+        bool is_display_format = itty_bit_string_list_is_display_format (format);
+        size_t max_length;
+        size_t *lengths = itty_bit_string_list_get_presentation_lengths (bit_string_list, format, &max_length);
+        size_t buffer_size;
+        size_t buffer_used = 0;
 
         if (is_display_format) {
                 buffer_size = strlen ("\t[\n\t]\n") + 1;
@@ -201,43 +789,136 @@ itty_bit_string_list_present (itty_bit_string_list_t                *bit_string_
                 buffer_size = 1;
         }
 
-        for (size_t i = 0; i < bit_string_list->count; i++) {
-                char *bit_string_representation = itty_bit_string_present (bit_string_list->bit_strings[i], format);
-                if (bit_string_representation) {
-                        size_t representation_length = max_length + (is_display_format ? strlen ("\t\t\n") : 0);
-                        buffer_size += representation_length;
-                        free (bit_string_representation);
-                }
-        }
+        buffer_size += bit_string_list->count * (max_length + (is_display_format ? strlen ("\t\t\n") : 0));
 
-        list_representation = malloc (buffer_size);
+        char *list_representation = malloc (buffer_size);
         if (!list_representation) {
+                free (lengths);
                 return NULL;
         }
 
         if (is_display_format) {
-                buffer_used += sprintf (&list_representation[buffer_used], "\t[\n");
+                memcpy (list_representation, "\t[\n", strlen ("\t[\n"));
+                buffer_used += strlen ("\t[\n");
         }
 
-        for (size_t i = 0; i < bit_string_list->count; i++) {
-                char *bit_string_representation = itty_bit_string_present (bit_string_list->bit_strings[i], format);
-                if (!bit_string_representation)
-                        continue;
+        for (size_t i = 0; i < bit_string_list->count; i++)
+                buffer_used += itty_bit_string_list_write_line (bit_string_list->bit_strings[i], format, is_display_format,
+                                                                lengths[i], max_length, list_representation + buffer_used);
 
-                if (is_display_format) {
-                        buffer_used += sprintf (&list_representation[buffer_used], "\t\t%*s\n", (int) max_length, bit_string_representation);
-                } else {
-                        buffer_used += sprintf (&list_representation[buffer_used], "%s", bit_string_representation);
-                }
+        if (is_display_format) {
+                memcpy (list_representation + buffer_used, "\t]\n", strlen ("\t]\n"));
+                buffer_used += strlen ("\t]\n");
+        }
+
+        list_representation[buffer_used] = '\0';
+        free (lengths);
+
+        return list_representation;
+}
 
-                free (bit_string_representation);
+bool
+itty_bit_string_list_present_to_file (itty_bit_string_list_t                *bit_string_list,
+                                      itty_bit_string_presentation_format_t  format,
+                                      FILE                                  *file)
+{
+        bool is_display_format = itty_bit_string_list_is_display_format (format);
+        size_t max_length;
+        size_t *lengths = itty_bit_string_list_get_presentation_lengths (bit_string_list, format, &max_length);
+        char *line = malloc (max_length + strlen ("\t\t\n") + 1);
+        bool succeeded = true;
+
+        if (is_display_format && fputs ("\t[\n", file) == EOF)
+                succeeded = false;
+
+        for (size_t i = 0; succeeded && i < bit_string_list->count; i++) {
+                size_t line_length = itty_bit_string_list_write_line (bit_string_list->bit_strings[i], format, is_display_format,
+                                                                      lengths[i], max_length, line);
+
+                if (fwrite (line, 1, line_length, file) != line_length)
+                        succeeded = false;
         }
 
-        if (is_display_format) {
-                buffer_used += sprintf (&list_representation[buffer_used], "\t]\n");
+        if (succeeded && is_display_format && fputs ("\t]\n", file) == EOF)
+                succeeded = false;
+
+        free (line);
+        free (lengths);
+
+        return succeeded;
+}
+
+static bool
+itty_bit_string_list_find_extreme_pop_count (itty_bit_string_list_t *list,
+                                             bool                    lowest,
+                                             size_t                 *index)
+{
+        size_t pop_counts[ITTY_BIT_STRING_LIST_POP_COUNT_BATCH_SIZE];
+        size_t best_pop_count = 0;
+        size_t best_index = 0;
+
+        if (list->count == 0)
+                return false;
+
+        for (size_t start = 0; start < list->count; start += ITTY_BIT_STRING_LIST_POP_COUNT_BATCH_SIZE) {
+                size_t end = start + ITTY_BIT_STRING_LIST_POP_COUNT_BATCH_SIZE < list->count ? start + ITTY_BIT_STRING_LIST_POP_COUNT_BATCH_SIZE : list->count;
+                itty_bit_string_list_pop_count_job_t job = { list, pop_counts, start };
+
+                itty_bit_string_list_count_range (&job, start, end);
+
+                for (size_t i = start; i < end; i++) {
+                        size_t pop_count = pop_counts[i - start];
+
+                        if (i == 0 || (lowest ? pop_count < best_pop_count : pop_count > best_pop_count)) {
+                                best_pop_count = pop_count;
+                                best_index = i;
+                        }
+                }
         }
 
-        return list_representation;
+        if (index)
+                *index = best_index;
+
+        return true;
+}
+
+bool
+itty_bit_string_list_get_pop_count_argmax (itty_bit_string_list_t *list,
+                                           size_t                 *index)
+{
+        return itty_bit_string_list_find_extreme_pop_count (list, false, index);
+}
+
+bool
+itty_bit_string_list_get_pop_count_argmin (itty_bit_string_list_t *list,
+                                           size_t                 *index)
+{
+        return itty_bit_string_list_find_extreme_pop_count (list, true, index);
+}
+
+/* Shares are differences of rounded running totals, so they always sum to total_weight */
+void
+itty_bit_string_list_get_pop_count_weights (itty_bit_string_list_t *list,
+                                            size_t                  total_weight,
+                                            size_t                 *weights)
+{
+        size_t total_pop_count = 0;
+        size_t cumulative_pop_count = 0;
+        size_t cumulative_weight = 0;
+
+        itty_bit_string_list_get_pop_counts (list, weights);
+
+        for (size_t i = 0; i < list->count; i++)
+                total_pop_count += weights[i];
+
+        for (size_t i = 0; i < list->count; i++) {
+                cumulative_pop_count += total_pop_count > 0 ? weights[i] : 1;
+
+                size_t weight = (unsigned __int128) cumulative_pop_count * total_weight / (total_pop_count > 0 ? total_pop_count : list->count);
+
+                weights[i] = weight - cumulative_weight;
+                cumulative_weight = weight;
+        }
 }
 
 itty_bit_string_list_t *
@@ -245,100 +926,307 @@ itty_bit_string_list_popcount_softmax (itty_bit_string_list_t *list,
                                        size_t                  num_words)
 {
         itty_bit_string_list_t *softmax_list = itty_bit_string_list_new ();
+        size_t *weights = malloc ((list->count > 0 ? list->count : 1) * sizeof (size_t));
 
-        size_t total_popcount = 0;
-        itty_bit_string_list_iterator_t iterator;
-        itty_bit_string_list_iterator_init (list, &iterator);
-        itty_bit_string_t *bit_string;
+        itty_bit_string_list_get_pop_count_weights (list, num_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS, weights);
 
-        while (itty_bit_string_list_iterator_next (&iterator, &bit_string)) {
-                total_popcount += itty_bit_string_get_pop_count (bit_string);
-        }
-
-        size_t cumulative_ones = 0;
-        itty_bit_string_list_iterator_init (list, &iterator);
-        while (itty_bit_string_list_iterator_next (&iterator, &bit_string)) {
+        for (size_t element = 0; element < list->count; element++) {
                 itty_bit_string_t *new_bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
-                size_t num_ones = (itty_bit_string_get_pop_count (bit_string) * ITTY_BIT_STRING_WORD_SIZE_IN_BITS + total_popcount - 1) / total_popcount;
-                cumulative_ones += num_ones;
-
-                size_t remaining_ones = num_ones;
-                for (size_t i = 0; i < num_words; i++) {
-                        size_t word = 0;
-                        if (remaining_ones > 0) {
-                                size_t ones_in_word = remaining_ones > ITTY_BIT_STRING_WORD_SIZE_IN_BITS ? ITTY_BIT_STRING_WORD_SIZE_IN_BITS : remaining_ones;
-                                word = (1UL << ones_in_word) - 1;
-                                remaining_ones -= ones_in_word;
-                        }
-                        itty_bit_string_append_word (new_bit_string, word);
-                }
+                size_t full_words = weights[element] / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                size_t remaining_ones = weights[element] % ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
 
-                itty_bit_string_list_append (softmax_list, new_bit_string);
-        }
+                itty_bit_string_append_zeros (new_bit_string, num_words);
+                for (size_t i = 0; i < full_words; i++)
+                        new_bit_string->words[i] = ~0UL;
+                if (remaining_ones > 0)
+                        new_bit_string->words[full_words] = (1UL << remaining_ones) - 1;
 
-        size_t total_bits = ITTY_BIT_STRING_WORD_SIZE_IN_BITS * num_words;
-        if (cumulative_ones != total_bits && softmax_list->count > 0) {
-                size_t excess_ones = cumulative_ones - total_bits;
-                size_t last_word_index = num_words - 1;
-                softmax_list->bit_strings[softmax_list->count - 1]->words[last_word_index] >>= excess_ones;
+                itty_bit_string_list_append (softmax_list, new_bit_string);
         }
+        free (weights);
 
         return softmax_list;
 }
 
+/* The softmax shares follow the pop counts, so num_words does not matter */
 bool
 itty_bit_string_list_popcount_argmax (itty_bit_string_list_t *list,
                                       size_t                  num_words,
                                       size_t                 *index)
 {
-        itty_bit_string_list_iterator_t iterator;
-        itty_bit_string_t *current_bit_string;
-        size_t highest_popcount = 0;
-        size_t i = 0;
-        bool found_one = false;
-
-        itty_bit_string_list_t *softmax = itty_bit_string_list_popcount_softmax (list, num_words);
-        itty_bit_string_list_iterator_init (softmax, &iterator);
-        while (itty_bit_string_list_iterator_next (&iterator, &current_bit_string)) {
-                size_t current_popcount = itty_bit_string_get_pop_count (current_bit_string);
-
-                if (!found_one) {
-                        found_one = true;
-                        if (index)
-                                *index = i;
+        (void) num_words;
+
+        return itty_bit_string_list_get_pop_count_argmax (list, index);
+}
+
+#define ITTY_BIT_STRING_LIST_RADIX_BITS 8
+#define ITTY_BIT_STRING_LIST_RADIX (1 << ITTY_BIT_STRING_LIST_RADIX_BITS)
+
+/* Least significant digit radix sort keeps equal pop counts in list order */
+static void
+itty_bit_string_list_sort_indices_by_pop_count (const size_t                 *pop_counts,
+                                                size_t                        count,
+                                                itty_bit_string_sort_order_t  order,
+                                                size_t                       *indices)
+{
+        size_t *scratch = malloc ((count > 0 ? count : 1) * sizeof (size_t));
+        size_t *source = indices;
+        size_t *destination = scratch;
+        size_t max_pop_count = 0;
+        size_t digit_mask = order == ITTY_BIT_STRING_SORT_ORDER_ASCENDING ? 0 : ITTY_BIT_STRING_LIST_RADIX - 1;
+
+        for (size_t i = 0; i < count; i++) {
+                indices[i] = i;
+                if (pop_counts[i] > max_pop_count)
+                        max_pop_count = pop_counts[i];
+        }
+
+        for (size_t shift = 0; shift < ITTY_BIT_STRING_WORD_SIZE_IN_BITS && (max_pop_count >> shift) != 0; shift += ITTY_BIT_STRING_LIST_RADIX_BITS) {
+                size_t offsets[ITTY_BIT_STRING_LIST_RADIX] = { 0 };
+                size_t offset = 0;
+
+                for (size_t i = 0; i < count; i++)
+                        offsets[((pop_counts[i] >> shift) & (ITTY_BIT_STRING_LIST_RADIX - 1)) ^ digit_mask]++;
+
+                for (size_t digit = 0; digit < ITTY_BIT_STRING_LIST_RADIX; digit++) {
+                        size_t digit_count = offsets[digit];
+
+                        offsets[digit] = offset;
+                        offset += digit_count;
                 }
 
-                if (current_popcount > highest_popcount) {
-                        highest_popcount = current_popcount;
+                for (size_t i = 0; i < count; i++) {
+                        size_t index = source[i];
 
-                        if (index)
-                                *index = i;
+                        destination[offsets[((pop_counts[index] >> shift) & (ITTY_BIT_STRING_LIST_RADIX - 1)) ^ digit_mask]++] = index;
                 }
-                i++;
+
+                size_t *sorted = destination;
+                destination = source;
+                source = sorted;
         }
-        itty_bit_string_list_free (softmax);
 
-        return found_one;
+        if (source != indices)
+                memcpy (indices, source, count * sizeof (size_t));
+
+        free (scratch);
 }
 
-static int
-itty_bit_string_compare_by_pop_count_qsort (const void *a,
-                                            const void *b,
-                                            void       *order)
+void
+itty_bit_string_list_get_sorted_indices (itty_bit_string_list_t       *list,
+                                         itty_bit_string_sort_order_t  order,
+                                         size_t                       *indices)
 {
-        itty_bit_string_t *itty_bit_string_a = *(itty_bit_string_t **) a;
-        itty_bit_string_t *itty_bit_string_b = *(itty_bit_string_t **) b;
-        itty_bit_string_sort_order_t sort_order = *(itty_bit_string_sort_order_t *) order;
-        return (sort_order == ITTY_BIT_STRING_SORT_ORDER_ASCENDING) ?
-                itty_bit_string_compare_by_pop_count (itty_bit_string_a, itty_bit_string_b) :
-                itty_bit_string_compare_by_pop_count (itty_bit_string_b, itty_bit_string_a);
+        size_t *pop_counts = malloc ((list->count > 0 ? list->count : 1) * sizeof (size_t));
+
+        itty_bit_string_list_get_pop_counts (list, pop_counts);
+        itty_bit_string_list_sort_indices_by_pop_count (pop_counts, list->count, order, indices);
+
+        free (pop_counts);
 }
 
 void
 itty_bit_string_list_sort (itty_bit_string_list_t      *list,
                            itty_bit_string_sort_order_t order)
 {
-        qsort_r (list->bit_strings, list->count, sizeof (itty_bit_string_t *), itty_bit_string_compare_by_pop_count_qsort, &order);
+        size_t *indices = malloc ((list->count > 0 ? list->count : 1) * sizeof (size_t));
+        itty_bit_string_t **bit_strings = malloc ((list->count > 0 ? list->count : 1) * sizeof (itty_bit_string_t *));
+
+        itty_bit_string_list_get_sorted_indices (list, order, indices);
+
+        for (size_t i = 0; i < list->count; i++)
+                bit_strings[i] = list->bit_strings[indices[i]];
+        memcpy (list->bit_strings, bit_strings, list->count * sizeof (itty_bit_string_t *));
+
+        free (bit_strings);
+        free (indices);
+}
+
+static inline bool
+itty_bit_string_list_ranks_below (const size_t *pop_counts,
+                                  size_t        a,
+                                  size_t        b)
+{
+        return pop_counts[a] < pop_counts[b] || (pop_counts[a] == pop_counts[b] && a > b);
+}
+
+static void
+itty_bit_string_list_sift_down (const size_t *pop_counts,
+                                size_t       *heap,
+                                size_t        heap_size,
+                                size_t        position)
+{
+        for (;;) {
+                size_t lowest = position;
+                size_t left = 2 * position + 1;
+                size_t right = left + 1;
+
+                if (left < heap_size && itty_bit_string_list_ranks_below (pop_counts, heap[left], heap[lowest]))
+                        lowest = left;
+                if (right < heap_size && itty_bit_string_list_ranks_below (pop_counts, heap[right], heap[lowest]))
+                        lowest = right;
+                if (lowest == position)
+                        return;
+
+                size_t index = heap[position];
+                heap[position] = heap[lowest];
+                heap[lowest] = index;
+                position = lowest;
+        }
+}
+
+static void
+itty_bit_string_list_select_top_indices (const size_t *pop_counts,
+                                         size_t        count,
+                                         size_t        k,
+                                         size_t       *indices)
+{
+        size_t heap_size = 0;
+
+        for (size_t i = 0; i < count; i++) {
+                if (heap_size < k) {
+                        size_t position = heap_size++;
+
+                        indices[position] = i;
+                        while (position > 0 && itty_bit_string_list_ranks_below (pop_counts, indices[position], indices[(position - 1) / 2])) {
+                                size_t parent = (position - 1) / 2;
+                                size_t index = indices[position];
+
+                                indices[position] = indices[parent];
+                                indices[parent] = index;
+                                position = parent;
+                        }
+                } else if (itty_bit_string_list_ranks_below (pop_counts, indices[0], i)) {
+                        indices[0] = i;
+                        itty_bit_string_list_sift_down (pop_counts, indices, heap_size, 0);
+                }
+        }
+
+        while (heap_size > 1) {
+                size_t index = indices[0];
+
+                indices[0] = indices[--heap_size];
+                indices[heap_size] = index;
+                itty_bit_string_list_sift_down (pop_counts, indices, heap_size, 0);
+        }
+}
+
+/* Ties go to the earlier element, matching itty_bit_string_list_popcount_argmax */
+size_t
+itty_bit_string_list_get_top_indices (itty_bit_string_list_t *list,
+                                      size_t                  k,
+                                      size_t                 *indices)
+{
+        if (k > list->count)
+                k = list->count;
+        if (k == 0)
+                return 0;
+
+        size_t *pop_counts = malloc (list->count * sizeof (size_t));
+
+        itty_bit_string_list_get_pop_counts (list, pop_counts);
+        itty_bit_string_list_select_top_indices (pop_counts, list->count, k, indices);
+
+        free (pop_counts);
+
+        return k;
+}
+
+#define ITTY_BIT_STRING_LIST_ATTENTION_ROW_TILES_PER_BLOCK 16
+
+itty_bit_string_list_t *
+itty_bit_string_list_attend (itty_bit_string_list_t *queries,
+                             itty_bit_string_list_t *keys,
+                             itty_bit_string_list_t *values,
+                             size_t                  number_of_selected)
+{
+        if (!queries || !keys || !values || keys->count != values->count) {
+                return NULL;
+        }
+
+        size_t number_of_rows = queries->count;
+        size_t number_of_columns = keys->count;
+        size_t number_of_words = 1;
+        size_t number_of_value_words = 0;
+
+        if (number_of_selected > number_of_columns)
+                number_of_selected = number_of_columns;
+
+        for (size_t i = 0; i < number_of_rows; i++) {
+                if (queries->bit_strings[i]->number_of_words > number_of_words)
+                        number_of_words = queries->bit_strings[i]->number_of_words;
+        }
+
+        for (size_t i = 0; i < number_of_columns; i++) {
+                if (keys->bit_strings[i]->number_of_words > number_of_words)
+                        number_of_words = keys->bit_strings[i]->number_of_words;
+                if (values->bit_strings[i]->number_of_words > number_of_value_words)
+                        number_of_value_words = values->bit_strings[i]->number_of_words;
+        }
+
+        itty_bit_string_list_t *result_list = itty_bit_string_list_new ();
+        itty_bit_string_t *rows = itty_bit_string_list_pack_rows (queries, number_of_words);
+        itty_bit_string_t *columns = itty_bit_string_list_pack_columns (keys, number_of_words);
+        size_t number_of_row_tiles = (number_of_rows + ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS - 1) / ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS;
+        size_t number_of_planes = ITTY_BIT_STRING_WORD_SIZE_IN_BITS - __builtin_clzl (number_of_selected | 1);
+        size_t threshold = number_of_selected / 2 + 1;
+        size_t counters[ITTY_BIT_STRING_WORD_SIZE_IN_BITS * ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE];
+        uint32_t *similarities = malloc ((ITTY_BIT_STRING_LIST_ATTENTION_ROW_TILES_PER_BLOCK * ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * number_of_columns + 1) * sizeof (uint32_t));
+        size_t *scores = malloc ((number_of_columns + 1) * sizeof (size_t));
+        size_t *selected = malloc ((number_of_selected + 1) * sizeof (size_t));
+        itty_bit_string_t **selected_values = malloc ((number_of_selected + 1) * sizeof (itty_bit_string_t *));
+
+        itty_bit_string_list_similarity_job_t job = { queries, keys, rows->words, columns->words, number_of_words, similarities, 0 };
+
+        for (size_t first_tile = 0; first_tile < number_of_row_tiles; first_tile += ITTY_BIT_STRING_LIST_ATTENTION_ROW_TILES_PER_BLOCK) {
+                size_t last_tile = first_tile + ITTY_BIT_STRING_LIST_ATTENTION_ROW_TILES_PER_BLOCK;
+                size_t last_row;
+
+                if (last_tile > number_of_row_tiles)
+                        last_tile = number_of_row_tiles;
+
+                job.first_row = first_tile * ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS;
+                itty_bit_string_list_evaluate_similarities_range (&job, first_tile, last_tile);
+
+                last_row = last_tile * ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS;
+                if (last_row > number_of_rows)
+                        last_row = number_of_rows;
+
+                for (size_t row = job.first_row; row < last_row; row++) {
+                        const uint32_t *row_similarities = similarities + (row - job.first_row) * number_of_columns;
+                        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+                        for (size_t column = 0; column < number_of_columns; column++)
+                                scores[column] = row_similarities[column];
+
+                        if (number_of_selected > 0)
+                                itty_bit_string_list_select_top_indices (scores, number_of_columns, number_of_selected, selected);
+                        for (size_t i = 0; i < number_of_selected; i++)
+                                selected_values[i] = values->bit_strings[selected[i]];
+
+                        itty_bit_string_append_zeros (result, number_of_value_words);
+                        for (size_t block_start = 0; block_start < number_of_value_words; block_start += ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE) {
+                                size_t block_size = number_of_value_words - block_start;
+
+                                if (block_size > ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE)
+                                        block_size = ITTY_BIT_STRING_LIST_CONDENSE_BLOCK_SIZE;
+
+                                itty_bit_string_list_condense_block (selected_values, number_of_selected, counters, number_of_planes, threshold,
+                                                                     block_start, block_size, result->words + block_start);
+                        }
+
+                        itty_bit_string_list_append (result_list, result);
+                }
+        }
+
+        free (selected_values);
+        free (selected);
+        free (scores);
+        free (similarities);
+        itty_bit_string_unref (rows);
+        itty_bit_string_unref (columns);
+
+        return result_list;
 }
 
 void
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "itty-bit-string.h"
+#include "itty-manager.h"
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct itty_bit_string_list_t itty_bit_string_list_t;
 typedef struct itty_bit_string_list_iterator_t itty_bit_string_list_iterator_t;
@@ -24,25 +26,68 @@ size_t itty_bit_string_list_get_bit_length (itty_bit_string_list_t *list);
 
 itty_bit_string_list_t *itty_bit_string_list_exclusive_or (itty_bit_string_list_t *list_a,
                                                            itty_bit_string_list_t *list_b);
+itty_bit_string_list_t *itty_bit_string_list_exclusive_or_with_manager (itty_bit_string_list_t *list_a,
+                                                                        itty_bit_string_list_t *list_b,
+                                                                        itty_manager_t         *manager);
 
 itty_bit_string_t *itty_bit_string_list_fetch (itty_bit_string_list_t *list,
                                                size_t                  index);
 
 itty_bit_string_t *itty_bit_string_list_condense (itty_bit_string_list_t *list);
+itty_bit_string_t *itty_bit_string_list_condense_with_threshold (itty_bit_string_list_t *list,
+                                                                 size_t                  threshold);
+itty_bit_string_t *itty_bit_string_list_condense_with_manager (itty_bit_string_list_t *list,
+                                                               itty_manager_t         *manager);
 
 itty_bit_string_list_t *itty_bit_string_list_transpose (itty_bit_string_list_t *list);
+itty_bit_string_list_t *itty_bit_string_list_transpose_with_manager (itty_bit_string_list_t *list,
+                                                                     itty_manager_t         *manager);
 
 size_t itty_bit_string_list_get_max_number_of_words (itty_bit_string_list_t *list);
 
+void itty_bit_string_list_get_pop_counts (itty_bit_string_list_t *list,
+                                          size_t                 *pop_counts);
+void itty_bit_string_list_get_pop_counts_with_manager (itty_bit_string_list_t *list,
+                                                       size_t                 *pop_counts,
+                                                       itty_manager_t         *manager);
+
+void itty_bit_string_list_evaluate_similarities (itty_bit_string_list_t *list_a,
+                                                 itty_bit_string_list_t *list_b,
+                                                 uint32_t               *similarities);
+void itty_bit_string_list_evaluate_similarities_with_manager (itty_bit_string_list_t *list_a,
+                                                              itty_bit_string_list_t *list_b,
+                                                              uint32_t               *similarities,
+                                                              itty_manager_t         *manager);
+
 char *itty_bit_string_list_present (itty_bit_string_list_t                *bit_string_list,
                                     itty_bit_string_presentation_format_t  format);
+bool itty_bit_string_list_present_to_file (itty_bit_string_list_t                *bit_string_list,
+                                           itty_bit_string_presentation_format_t  format,
+                                           FILE                                  *file);
 itty_bit_string_list_t *itty_bit_string_list_popcount_softmax (itty_bit_string_list_t *list,
                                                                size_t                  num_words);
 bool itty_bit_string_list_popcount_argmax (itty_bit_string_list_t *list,
                                            size_t                  num_words,
                                            size_t                 *index);
+bool itty_bit_string_list_get_pop_count_argmax (itty_bit_string_list_t *list,
+                                                size_t                 *index);
+bool itty_bit_string_list_get_pop_count_argmin (itty_bit_string_list_t *list,
+                                                size_t                 *index);
+void itty_bit_string_list_get_pop_count_weights (itty_bit_string_list_t *list,
+                                                 size_t                  total_weight,
+                                                 size_t                 *weights);
 void itty_bit_string_list_sort (itty_bit_string_list_t      *list,
                                 itty_bit_string_sort_order_t order);
+void itty_bit_string_list_get_sorted_indices (itty_bit_string_list_t       *list,
+                                              itty_bit_string_sort_order_t  order,
+                                              size_t                       *indices);
+size_t itty_bit_string_list_get_top_indices (itty_bit_string_list_t *list,
+                                             size_t                  k,
+                                             size_t                 *indices);
+itty_bit_string_list_t *itty_bit_string_list_attend (itty_bit_string_list_t *queries,
+                                                     itty_bit_string_list_t *keys,
+                                                     itty_bit_string_list_t *values,
+                                                     size_t                  number_of_selected);
 
 void itty_bit_string_list_iterator_init (itty_bit_string_list_t          *list,
                                          itty_bit_string_list_iterator_t *iterator);
@@ -39,7 +39,6 @@ itty_bit_string_map_file_new (const char *file_name)
 
         }
         mapped_file->current_index = 0;
-        mapped_file->bit_string_list = itty_bit_string_list_new ();
 
         return mapped_file;
 }
@@ -51,14 +50,6 @@ itty_bit_string_map_file_free (itty_bit_string_map_file_t *mapped_file)
                 return;
         }
 
-        itty_bit_string_list_iterator_t iterator;
-        itty_bit_string_list_iterator_init (mapped_file->bit_string_list, &iterator);
-        itty_bit_string_t *bit_string;
-        while (itty_bit_string_list_iterator_next (&iterator, &bit_string)) {
-                bit_string->words = NULL;  // Clear the words pointer
-        }
-
-        itty_bit_string_list_free (mapped_file->bit_string_list);
         munmap (mapped_file->mapped_data, mapped_file->file_size);
         close (mapped_file->fd);
         free (mapped_file);
@@ -83,6 +74,44 @@ itty_bit_string_map_file_next (itty_bit_string_map_file_t  *mapped_file,
         return bit_string;
 }
 
+itty_bit_string_t *
+itty_bit_string_map_file_next_aligned (itty_bit_string_map_file_t *mapped_file,
+                                       size_t                      number_of_words)
+{
+        size_t total_words = mapped_file->file_size / ITTY_BIT_STRING_WORD_SIZE_IN_BYTES;
+        size_t padded_number_of_words = (number_of_words + ITTY_BIT_STRING_WORDS_PER_ALIGNMENT - 1) & ~(ITTY_BIT_STRING_WORDS_PER_ALIGNMENT - 1);
+
+        mapped_file->current_index = (mapped_file->current_index + ITTY_BIT_STRING_WORDS_PER_ALIGNMENT - 1) & ~(ITTY_BIT_STRING_WORDS_PER_ALIGNMENT - 1);
+        if (mapped_file->current_index + padded_number_of_words > total_words) {
+                return NULL;
+        }
+
+        itty_bit_string_t *bit_string = itty_bit_string_map_file_next (mapped_file, number_of_words);
+        bit_string->aligned = true;
+        mapped_file->current_index += padded_number_of_words - number_of_words;
+
+        return bit_string;
+}
+
+itty_bit_matrix_t *
+itty_bit_string_map_file_next_matrix (itty_bit_string_map_file_t *mapped_file,
+                                      size_t                      number_of_rows,
+                                      size_t                      number_of_words)
+{
+        size_t total_words = mapped_file->file_size / ITTY_BIT_STRING_WORD_SIZE_IN_BYTES;
+        size_t number_of_matrix_words = number_of_rows * number_of_words;
+
+        if (mapped_file->current_index > total_words ||
+            number_of_matrix_words > total_words - mapped_file->current_index ||
+            number_of_matrix_words == 0) {
+                return NULL;
+        }
+
+        itty_bit_string_t *bit_string = itty_bit_string_map_file_next (mapped_file, number_of_matrix_words);
+
+        return itty_bit_matrix_new_for_bit_string (bit_string, number_of_rows, number_of_words);
+}
+
 char *
 itty_bit_string_map_file_get_mapped_data (itty_bit_string_map_file_t *mapped_file)
 {
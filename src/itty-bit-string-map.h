@@ -1,5 +1,6 @@
 #pragma once
 
+#include "itty-bit-matrix.h"
 #include "itty-bit-string-list.h"
 #include <stddef.h>
 #include <stdbool.h>
@@ -12,6 +13,11 @@ void itty_bit_string_map_file_free (itty_bit_string_map_file_t *mapped_file);
 
 itty_bit_string_t *itty_bit_string_map_file_next (itty_bit_string_map_file_t *mapped_file,
                                                   size_t                      number_of_words);
+itty_bit_string_t *itty_bit_string_map_file_next_aligned (itty_bit_string_map_file_t *mapped_file,
+                                                          size_t                      number_of_words);
+itty_bit_matrix_t *itty_bit_string_map_file_next_matrix (itty_bit_string_map_file_t *mapped_file,
+                                                         size_t                      number_of_rows,
+                                                         size_t                      number_of_words);
 char *itty_bit_string_map_file_get_mapped_data (itty_bit_string_map_file_t *mapped_file);
 
 bool itty_bit_string_map_file_resize (itty_bit_string_map_file_t *mapped_file,
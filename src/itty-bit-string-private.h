@@ -1,18 +1,41 @@
 #pragma once
 
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+#include "itty-arena.h"
+#include "itty-bit-string-sparse-private.h"
 
 typedef enum itty_bit_string_mutability_t itty_bit_string_mutability_t;
 
+#define ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS 4
+#define ITTY_BIT_STRING_ALIGNMENT 64
+#define ITTY_BIT_STRING_WORDS_PER_ALIGNMENT (ITTY_BIT_STRING_ALIGNMENT / ITTY_BIT_STRING_WORD_SIZE_IN_BYTES)
+
 struct itty_bit_string_t {
+        /* NULL while sparse; shared strings are always dense */
         size_t *words;
         size_t number_of_words;
+        /* Zero while words belongs to someone else */
+        size_t capacity;
         size_t pop_count;
         size_t bit_length;
+        uint64_t hash;
         itty_bit_string_mutability_t mutability;
+        itty_arena_t *arena;
+        /* Views borrow their words from this storage string */
+        itty_bit_string_t *parent;
+        itty_bit_string_sparse_t *sparse;
+        atomic_size_t reference_count;
         unsigned long pop_count_computed : 1;
         unsigned long bit_length_computed : 1;
+        unsigned long hash_computed : 1;
+        /* Padding up to the alignment is readable, and scratch when owned */
+        unsigned long aligned : 1;
+        /* words may point here, so never copy the struct by value */
+        size_t inline_words[ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS];
 };
 
 static inline void
@@ -29,3 +52,20 @@ itty_bit_string_set_bit (itty_bit_string_t *bit_string,
                 bit_string->words[word_index] &= ~(1UL << bit_position);
         }
 }
+
+static inline size_t
+itty_bit_string_get_word (itty_bit_string_t *bit_string,
+                          size_t             word_index)
+{
+        if (bit_string->sparse != NULL)
+                return itty_bit_string_sparse_get_word (bit_string->sparse, word_index);
+
+        return bit_string->words[word_index];
+}
+
+void itty_bit_string_copy_words (itty_bit_string_t *bit_string,
+                                 size_t            *words,
+                                 size_t             number_of_words);
+
+/* Converts a sparse string to dense form in place, so only its single holder may call it */
+void itty_bit_string_make_dense (itty_bit_string_t *bit_string);
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "itty-arena.h"
+
+#define ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER 1024
+#define ITTY_BIT_STRING_SPARSE_BITS_PER_CONTAINER (ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER * 64)
+#define ITTY_BIT_STRING_SPARSE_MAXIMUM_ARRAY_CARDINALITY 4096
+
+typedef struct itty_bit_string_sparse_t itty_bit_string_sparse_t;
+typedef struct itty_bit_string_container_t itty_bit_string_container_t;
+typedef struct itty_bit_string_run_t itty_bit_string_run_t;
+typedef enum itty_bit_string_container_type_t itty_bit_string_container_type_t;
+
+enum itty_bit_string_container_type_t {
+        ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY,
+        ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP,
+        ITTY_BIT_STRING_CONTAINER_TYPE_RUN,
+};
+
+/* A run covers the bits from start through start + length inclusive */
+struct itty_bit_string_run_t {
+        uint16_t start;
+        uint16_t length;
+};
+
+/* Containers without any set bits are left out entirely */
+struct itty_bit_string_container_t {
+        size_t                           key;
+        itty_bit_string_container_type_t type;
+        uint32_t                         cardinality;
+        uint32_t                         size;
+        union {
+                uint16_t              *values;
+                size_t                *words;
+                itty_bit_string_run_t *runs;
+        };
+};
+
+/* Sparse strings are immutable once built */
+struct itty_bit_string_sparse_t {
+        itty_arena_t                *arena;
+        itty_bit_string_container_t *containers;
+        size_t                       number_of_containers;
+        size_t                       cardinality;
+};
+
+itty_bit_string_sparse_t *itty_bit_string_sparse_new_from_words (itty_arena_t *arena,
+                                                                 const size_t *words,
+                                                                 size_t        number_of_words);
+void itty_bit_string_sparse_free (itty_bit_string_sparse_t *sparse);
+
+void itty_bit_string_sparse_get_words (itty_bit_string_sparse_t *sparse,
+                                       size_t                   *words,
+                                       size_t                    number_of_words);
+
+/* bitmap must hold a whole container */
+const size_t *itty_bit_string_sparse_get_container_words (itty_bit_string_container_t *container,
+                                                          size_t                      *bitmap);
+size_t itty_bit_string_sparse_get_first_word (itty_bit_string_sparse_t *sparse,
+                                              size_t                    number_of_words,
+                                              size_t                   *word);
+size_t itty_bit_string_sparse_get_word (itty_bit_string_sparse_t *sparse,
+                                        size_t                    word_index);
+
+itty_bit_string_sparse_t *itty_bit_string_sparse_mask (itty_arena_t             *arena,
+                                                       itty_bit_string_sparse_t *a,
+                                                       itty_bit_string_sparse_t *b);
+itty_bit_string_sparse_t *itty_bit_string_sparse_combine (itty_arena_t             *arena,
+                                                          itty_bit_string_sparse_t *a,
+                                                          itty_bit_string_sparse_t *b);
+itty_bit_string_sparse_t *itty_bit_string_sparse_exclusive_or (itty_arena_t             *arena,
+                                                               itty_bit_string_sparse_t *a,
+                                                               itty_bit_string_sparse_t *b);
+itty_bit_string_sparse_t *itty_bit_string_sparse_mask_words (itty_arena_t             *arena,
+                                                             itty_bit_string_sparse_t *sparse,
+                                                             const size_t             *words,
+                                                             size_t                    number_of_words);
+
+void itty_bit_string_sparse_combine_into_words (itty_bit_string_sparse_t *sparse,
+                                                size_t                   *words,
+                                                size_t                    number_of_words);
+void itty_bit_string_sparse_exclusive_or_into_words (itty_bit_string_sparse_t *sparse,
+                                                     size_t                   *words,
+                                                     size_t                    number_of_words);
+
+size_t itty_bit_string_sparse_evaluate_overlap (itty_bit_string_sparse_t *a,
+                                                itty_bit_string_sparse_t *b);
+size_t itty_bit_string_sparse_evaluate_overlap_with_words (itty_bit_string_sparse_t *sparse,
+                                                           const size_t             *words,
+                                                           size_t                    number_of_words);
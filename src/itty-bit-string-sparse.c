@@ -0,0 +1,770 @@
+#include "itty-bit-string-sparse-private.h"
+#include "itty-bit-string.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+        ITTY_BIT_STRING_SPARSE_OPERATION_MASK,
+        ITTY_BIT_STRING_SPARSE_OPERATION_COMBINE,
+        ITTY_BIT_STRING_SPARSE_OPERATION_EXCLUSIVE_OR,
+} itty_bit_string_sparse_operation_t;
+
+static void *
+itty_bit_string_sparse_allocate (itty_arena_t *arena,
+                                 size_t        size)
+{
+        if (arena != NULL)
+                return itty_arena_allocate (arena, size);
+
+        return malloc (size);
+}
+
+static itty_bit_string_sparse_t *
+itty_bit_string_sparse_new (itty_arena_t *arena,
+                            size_t        maximum_number_of_containers)
+{
+        itty_bit_string_sparse_t *sparse = itty_bit_string_sparse_allocate (arena, sizeof (itty_bit_string_sparse_t));
+
+        sparse->arena = arena;
+        sparse->containers = NULL;
+        sparse->number_of_containers = 0;
+        sparse->cardinality = 0;
+
+        if (maximum_number_of_containers > 0)
+                sparse->containers = itty_bit_string_sparse_allocate (arena, maximum_number_of_containers * sizeof (itty_bit_string_container_t));
+
+        return sparse;
+}
+
+void
+itty_bit_string_sparse_free (itty_bit_string_sparse_t *sparse)
+{
+        if (!sparse || sparse->arena != NULL)
+                return;
+
+        for (size_t i = 0; i < sparse->number_of_containers; i++)
+                free (sparse->containers[i].values);
+
+        free (sparse->containers);
+        free (sparse);
+}
+
+static size_t
+itty_bit_string_sparse_get_container_number_of_words (size_t key,
+                                                      size_t number_of_words)
+{
+        size_t remaining_words = number_of_words - key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+
+        if (remaining_words > ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER)
+                return ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+
+        return remaining_words;
+}
+
+static void
+itty_bit_string_sparse_set_range (size_t *bitmap,
+                                  size_t  first,
+                                  size_t  last)
+{
+        size_t first_word = first / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t last_word = last / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t first_mask = ~0UL << (first % ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+        size_t last_mask = ~0UL >> (ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1 - last % ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+
+        if (first_word == last_word) {
+                bitmap[first_word] |= first_mask & last_mask;
+                return;
+        }
+
+        bitmap[first_word] |= first_mask;
+        for (size_t i = first_word + 1; i < last_word; i++)
+                bitmap[i] = ~0UL;
+        bitmap[last_word] |= last_mask;
+}
+
+static void
+itty_bit_string_container_get_bitmap (itty_bit_string_container_t *container,
+                                      size_t                      *bitmap)
+{
+        switch (container->type) {
+        case ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY:
+                memset (bitmap, 0, ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                for (size_t i = 0; i < container->size; i++) {
+                        uint16_t value = container->values[i];
+                        bitmap[value / ITTY_BIT_STRING_WORD_SIZE_IN_BITS] |= 1UL << (value % ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+                }
+                break;
+        case ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP:
+                memcpy (bitmap, container->words, ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                break;
+        case ITTY_BIT_STRING_CONTAINER_TYPE_RUN:
+                memset (bitmap, 0, ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                for (size_t i = 0; i < container->size; i++) {
+                        itty_bit_string_run_t run = container->runs[i];
+                        itty_bit_string_sparse_set_range (bitmap, run.start, (size_t) run.start + run.length);
+                }
+                break;
+        }
+}
+
+static size_t
+itty_bit_string_sparse_count_runs (const size_t *bitmap)
+{
+        size_t number_of_runs = 0;
+        size_t previous_high_bit = 0;
+
+        for (size_t i = 0; i < ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER; i++) {
+                size_t word = bitmap[i];
+
+                number_of_runs += __builtin_popcountl (word & ~((word << 1) | previous_high_bit));
+                previous_high_bit = word >> (ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1);
+        }
+
+        return number_of_runs;
+}
+
+static void
+itty_bit_string_sparse_get_runs (const size_t          *bitmap,
+                                 itty_bit_string_run_t *runs)
+{
+        size_t number_of_runs = 0;
+        size_t run_start = 0;
+        bool in_run = false;
+
+        for (size_t i = 0; i < ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER; i++) {
+                size_t word = bitmap[i];
+                size_t base = i * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                size_t bit = 0;
+
+                while (bit < ITTY_BIT_STRING_WORD_SIZE_IN_BITS) {
+                        size_t remaining = in_run ? ~word >> bit : word >> bit;
+
+                        if (remaining == 0)
+                                break;
+
+                        bit += __builtin_ctzl (remaining);
+                        if (in_run) {
+                                runs[number_of_runs].start = run_start;
+                                runs[number_of_runs].length = base + bit - 1 - run_start;
+                                number_of_runs++;
+                        } else {
+                                run_start = base + bit;
+                        }
+                        in_run = !in_run;
+                }
+        }
+
+        if (in_run) {
+                runs[number_of_runs].start = run_start;
+                runs[number_of_runs].length = ITTY_BIT_STRING_SPARSE_BITS_PER_CONTAINER - 1 - run_start;
+        }
+}
+
+static void
+itty_bit_string_sparse_append_bitmap (itty_bit_string_sparse_t *sparse,
+                                      size_t                    key,
+                                      const size_t             *bitmap)
+{
+        size_t cardinality = 0;
+
+        for (size_t i = 0; i < ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER; i++)
+                cardinality += __builtin_popcountl (bitmap[i]);
+
+        if (cardinality == 0)
+                return;
+
+        size_t number_of_runs = itty_bit_string_sparse_count_runs (bitmap);
+        size_t array_size = cardinality * sizeof (uint16_t);
+        size_t run_size = number_of_runs * sizeof (itty_bit_string_run_t);
+        size_t bitmap_size = ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES;
+        itty_bit_string_container_t *container = &sparse->containers[sparse->number_of_containers];
+
+        container->key = key;
+        container->cardinality = cardinality;
+
+        if (run_size < array_size && run_size < bitmap_size) {
+                container->type = ITTY_BIT_STRING_CONTAINER_TYPE_RUN;
+                container->size = number_of_runs;
+                container->runs = itty_bit_string_sparse_allocate (sparse->arena, run_size);
+                itty_bit_string_sparse_get_runs (bitmap, container->runs);
+        } else if (cardinality <= ITTY_BIT_STRING_SPARSE_MAXIMUM_ARRAY_CARDINALITY) {
+                size_t number_of_values = 0;
+
+                container->type = ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY;
+                container->size = cardinality;
+                container->values = itty_bit_string_sparse_allocate (sparse->arena, array_size);
+                for (size_t i = 0; i < ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER; i++) {
+                        for (size_t word = bitmap[i]; word != 0; word &= word - 1)
+                                container->values[number_of_values++] = i * ITTY_BIT_STRING_WORD_SIZE_IN_BITS + __builtin_ctzl (word);
+                }
+        } else {
+                container->type = ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP;
+                container->size = ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+                container->words = itty_bit_string_sparse_allocate (sparse->arena, bitmap_size);
+                memcpy (container->words, bitmap, bitmap_size);
+        }
+
+        sparse->number_of_containers++;
+        sparse->cardinality += cardinality;
+}
+
+static void
+itty_bit_string_sparse_append_values (itty_bit_string_sparse_t *sparse,
+                                      size_t                    key,
+                                      const uint16_t           *values,
+                                      size_t                    number_of_values)
+{
+        if (number_of_values == 0)
+                return;
+
+        if (number_of_values > ITTY_BIT_STRING_SPARSE_MAXIMUM_ARRAY_CARDINALITY) {
+                size_t bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER] = { 0 };
+
+                for (size_t i = 0; i < number_of_values; i++)
+                        bitmap[values[i] / ITTY_BIT_STRING_WORD_SIZE_IN_BITS] |= 1UL << (values[i] % ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+
+                itty_bit_string_sparse_append_bitmap (sparse, key, bitmap);
+                return;
+        }
+
+        itty_bit_string_container_t *container = &sparse->containers[sparse->number_of_containers];
+
+        container->key = key;
+        container->type = ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY;
+        container->cardinality = number_of_values;
+        container->size = number_of_values;
+        container->values = itty_bit_string_sparse_allocate (sparse->arena, number_of_values * sizeof (uint16_t));
+        memcpy (container->values, values, number_of_values * sizeof (uint16_t));
+
+        sparse->number_of_containers++;
+        sparse->cardinality += number_of_values;
+}
+
+static void
+itty_bit_string_sparse_append_copy (itty_bit_string_sparse_t    *sparse,
+                                    itty_bit_string_container_t *container)
+{
+        itty_bit_string_container_t *copy = &sparse->containers[sparse->number_of_containers];
+        size_t size;
+
+        switch (container->type) {
+        case ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY:
+                size = container->size * sizeof (uint16_t);
+                break;
+        case ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP:
+                size = container->size * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES;
+                break;
+        case ITTY_BIT_STRING_CONTAINER_TYPE_RUN:
+        default:
+                size = container->size * sizeof (itty_bit_string_run_t);
+                break;
+        }
+
+        *copy = *container;
+        copy->values = itty_bit_string_sparse_allocate (sparse->arena, size);
+        memcpy (copy->values, container->values, size);
+
+        sparse->number_of_containers++;
+        sparse->cardinality += container->cardinality;
+}
+
+itty_bit_string_sparse_t *
+itty_bit_string_sparse_new_from_words (itty_arena_t *arena,
+                                       const size_t *words,
+                                       size_t        number_of_words)
+{
+        size_t number_of_keys = (number_of_words + ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER - 1) / ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+        itty_bit_string_sparse_t *sparse = itty_bit_string_sparse_new (arena, number_of_keys);
+        size_t bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+
+        for (size_t key = 0; key < number_of_keys; key++) {
+                size_t container_number_of_words = itty_bit_string_sparse_get_container_number_of_words (key, number_of_words);
+
+                memcpy (bitmap, words + key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER, container_number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                memset (bitmap + container_number_of_words, 0, (ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER - container_number_of_words) * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                itty_bit_string_sparse_append_bitmap (sparse, key, bitmap);
+        }
+
+        return sparse;
+}
+
+void
+itty_bit_string_sparse_get_words (itty_bit_string_sparse_t *sparse,
+                                  size_t                   *words,
+                                  size_t                    number_of_words)
+{
+        memset (words, 0, number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        itty_bit_string_sparse_combine_into_words (sparse, words, number_of_words);
+}
+
+const size_t *
+itty_bit_string_sparse_get_container_words (itty_bit_string_container_t *container,
+                                            size_t                      *bitmap)
+{
+        if (container->type == ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP)
+                return container->words;
+
+        itty_bit_string_container_get_bitmap (container, bitmap);
+        return bitmap;
+}
+
+size_t
+itty_bit_string_sparse_get_first_word (itty_bit_string_sparse_t *sparse,
+                                       size_t                    number_of_words,
+                                       size_t                   *word)
+{
+        *word = 0;
+
+        if (sparse->number_of_containers == 0)
+                return number_of_words;
+
+        itty_bit_string_container_t *container = &sparse->containers[0];
+        size_t word_index = 0;
+
+        switch (container->type) {
+        case ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY:
+                word_index = container->values[0] / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                for (size_t i = 0; i < container->size && container->values[i] / ITTY_BIT_STRING_WORD_SIZE_IN_BITS == word_index; i++)
+                        *word |= 1UL << (container->values[i] % ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+                break;
+        case ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP:
+                while (container->words[word_index] == 0)
+                        word_index++;
+                *word = container->words[word_index];
+                break;
+        case ITTY_BIT_STRING_CONTAINER_TYPE_RUN:
+                word_index = container->runs[0].start / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                for (size_t i = 0; i < container->size && container->runs[i].start / ITTY_BIT_STRING_WORD_SIZE_IN_BITS == word_index; i++) {
+                        size_t first = container->runs[i].start - word_index * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                        size_t last = first + container->runs[i].length;
+
+                        if (last >= ITTY_BIT_STRING_WORD_SIZE_IN_BITS)
+                                last = ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1;
+
+                        itty_bit_string_sparse_set_range (word, first, last);
+                }
+                break;
+        }
+
+        return container->key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER + word_index;
+}
+
+size_t
+itty_bit_string_sparse_get_word (itty_bit_string_sparse_t *sparse,
+                                 size_t                    word_index)
+{
+        size_t key = word_index / ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+        size_t first = (word_index % ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER) * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t last = first + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1;
+        size_t low = 0;
+        size_t high = sparse->number_of_containers;
+        size_t word = 0;
+
+        while (low < high) {
+                size_t middle = (low + high) / 2;
+
+                if (sparse->containers[middle].key < key)
+                        low = middle + 1;
+                else
+                        high = middle;
+        }
+
+        if (low == sparse->number_of_containers || sparse->containers[low].key != key)
+                return 0;
+
+        itty_bit_string_container_t *container = &sparse->containers[low];
+
+        low = 0;
+        high = container->size;
+
+        switch (container->type) {
+        case ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY:
+                while (low < high) {
+                        size_t middle = (low + high) / 2;
+
+                        if (container->values[middle] < first)
+                                low = middle + 1;
+                        else
+                                high = middle;
+                }
+
+                for (size_t i = low; i < container->size && container->values[i] <= last; i++)
+                        word |= 1UL << (container->values[i] % ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+                break;
+        case ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP:
+                word = container->words[word_index % ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+                break;
+        case ITTY_BIT_STRING_CONTAINER_TYPE_RUN:
+                while (low < high) {
+                        size_t middle = (low + high) / 2;
+
+                        if ((size_t) container->runs[middle].start + container->runs[middle].length < first)
+                                low = middle + 1;
+                        else
+                                high = middle;
+                }
+
+                for (size_t i = low; i < container->size && container->runs[i].start <= last; i++) {
+                        size_t run_first = container->runs[i].start;
+                        size_t run_last = run_first + container->runs[i].length;
+
+                        if (run_first < first)
+                                run_first = first;
+                        if (run_last > last)
+                                run_last = last;
+
+                        itty_bit_string_sparse_set_range (&word, run_first - first, run_last - first);
+                }
+                break;
+        }
+
+        return word;
+}
+
+static size_t
+itty_bit_string_sparse_merge_values (const uint16_t                     *a,
+                                     size_t                              a_size,
+                                     const uint16_t                     *b,
+                                     size_t                              b_size,
+                                     itty_bit_string_sparse_operation_t  operation,
+                                     uint16_t                           *values)
+{
+        size_t number_of_values = 0;
+        size_t i = 0, j = 0;
+        bool keep_unmatched = operation != ITTY_BIT_STRING_SPARSE_OPERATION_MASK;
+        bool keep_matched = operation != ITTY_BIT_STRING_SPARSE_OPERATION_EXCLUSIVE_OR;
+
+        while (i < a_size && j < b_size) {
+                if (a[i] < b[j]) {
+                        if (keep_unmatched)
+                                values[number_of_values++] = a[i];
+                        i++;
+                } else if (b[j] < a[i]) {
+                        if (keep_unmatched)
+                                values[number_of_values++] = b[j];
+                        j++;
+                } else {
+                        if (keep_matched)
+                                values[number_of_values++] = a[i];
+                        i++;
+                        j++;
+                }
+        }
+
+        if (keep_unmatched) {
+                for (; i < a_size; i++)
+                        values[number_of_values++] = a[i];
+                for (; j < b_size; j++)
+                        values[number_of_values++] = b[j];
+        }
+
+        return number_of_values;
+}
+
+static void
+itty_bit_string_sparse_append_combination (itty_bit_string_sparse_t           *sparse,
+                                           itty_bit_string_container_t        *a,
+                                           itty_bit_string_container_t        *b,
+                                           itty_bit_string_sparse_operation_t  operation)
+{
+        if (a->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY && b->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY) {
+                uint16_t values[2 * ITTY_BIT_STRING_SPARSE_MAXIMUM_ARRAY_CARDINALITY];
+                size_t number_of_values = itty_bit_string_sparse_merge_values (a->values, a->size, b->values, b->size, operation, values);
+
+                itty_bit_string_sparse_append_values (sparse, a->key, values, number_of_values);
+                return;
+        }
+
+        size_t a_bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+        size_t b_bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+
+        itty_bit_string_container_get_bitmap (a, a_bitmap);
+        itty_bit_string_container_get_bitmap (b, b_bitmap);
+
+        for (size_t i = 0; i < ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER; i++) {
+                switch (operation) {
+                case ITTY_BIT_STRING_SPARSE_OPERATION_MASK:
+                        a_bitmap[i] &= b_bitmap[i];
+                        break;
+                case ITTY_BIT_STRING_SPARSE_OPERATION_COMBINE:
+                        a_bitmap[i] |= b_bitmap[i];
+                        break;
+                case ITTY_BIT_STRING_SPARSE_OPERATION_EXCLUSIVE_OR:
+                        a_bitmap[i] ^= b_bitmap[i];
+                        break;
+                }
+        }
+
+        itty_bit_string_sparse_append_bitmap (sparse, a->key, a_bitmap);
+}
+
+static itty_bit_string_sparse_t *
+itty_bit_string_sparse_apply (itty_arena_t                       *arena,
+                              itty_bit_string_sparse_t           *a,
+                              itty_bit_string_sparse_t           *b,
+                              itty_bit_string_sparse_operation_t  operation)
+{
+        size_t maximum_number_of_containers = a->number_of_containers + b->number_of_containers;
+        bool keep_unmatched = operation != ITTY_BIT_STRING_SPARSE_OPERATION_MASK;
+        size_t i = 0, j = 0;
+
+        itty_bit_string_sparse_t *result = itty_bit_string_sparse_new (arena, maximum_number_of_containers);
+
+        while (i < a->number_of_containers || j < b->number_of_containers) {
+                itty_bit_string_container_t *a_container = i < a->number_of_containers ? &a->containers[i] : NULL;
+                itty_bit_string_container_t *b_container = j < b->number_of_containers ? &b->containers[j] : NULL;
+
+                if (b_container == NULL || (a_container != NULL && a_container->key < b_container->key)) {
+                        if (keep_unmatched)
+                                itty_bit_string_sparse_append_copy (result, a_container);
+                        i++;
+                } else if (a_container == NULL || b_container->key < a_container->key) {
+                        if (keep_unmatched)
+                                itty_bit_string_sparse_append_copy (result, b_container);
+                        j++;
+                } else {
+                        itty_bit_string_sparse_append_combination (result, a_container, b_container, operation);
+                        i++;
+                        j++;
+                }
+        }
+
+        return result;
+}
+
+itty_bit_string_sparse_t *
+itty_bit_string_sparse_mask (itty_arena_t             *arena,
+                             itty_bit_string_sparse_t *a,
+                             itty_bit_string_sparse_t *b)
+{
+        return itty_bit_string_sparse_apply (arena, a, b, ITTY_BIT_STRING_SPARSE_OPERATION_MASK);
+}
+
+itty_bit_string_sparse_t *
+itty_bit_string_sparse_combine (itty_arena_t             *arena,
+                                itty_bit_string_sparse_t *a,
+                                itty_bit_string_sparse_t *b)
+{
+        return itty_bit_string_sparse_apply (arena, a, b, ITTY_BIT_STRING_SPARSE_OPERATION_COMBINE);
+}
+
+itty_bit_string_sparse_t *
+itty_bit_string_sparse_exclusive_or (itty_arena_t             *arena,
+                                     itty_bit_string_sparse_t *a,
+                                     itty_bit_string_sparse_t *b)
+{
+        return itty_bit_string_sparse_apply (arena, a, b, ITTY_BIT_STRING_SPARSE_OPERATION_EXCLUSIVE_OR);
+}
+
+itty_bit_string_sparse_t *
+itty_bit_string_sparse_mask_words (itty_arena_t             *arena,
+                                   itty_bit_string_sparse_t *sparse,
+                                   const size_t             *words,
+                                   size_t                    number_of_words)
+{
+        itty_bit_string_sparse_t *result = itty_bit_string_sparse_new (arena, sparse->number_of_containers);
+
+        for (size_t i = 0; i < sparse->number_of_containers; i++) {
+                itty_bit_string_container_t *container = &sparse->containers[i];
+
+                if (container->key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER >= number_of_words)
+                        break;
+
+                const size_t *container_words = words + container->key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+                size_t container_number_of_words = itty_bit_string_sparse_get_container_number_of_words (container->key, number_of_words);
+
+                if (container->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY) {
+                        uint16_t values[ITTY_BIT_STRING_SPARSE_MAXIMUM_ARRAY_CARDINALITY];
+                        size_t number_of_values = 0;
+
+                        for (size_t j = 0; j < container->size; j++) {
+                                uint16_t value = container->values[j];
+                                size_t word_index = value / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+                                if ((container_words[word_index] >> (value % ITTY_BIT_STRING_WORD_SIZE_IN_BITS)) & 1)
+                                        values[number_of_values++] = value;
+                        }
+
+                        itty_bit_string_sparse_append_values (result, container->key, values, number_of_values);
+                        continue;
+                }
+
+                size_t bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+
+                itty_bit_string_container_get_bitmap (container, bitmap);
+                for (size_t j = 0; j < ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER; j++)
+                        bitmap[j] &= j < container_number_of_words ? container_words[j] : 0;
+
+                itty_bit_string_sparse_append_bitmap (result, container->key, bitmap);
+        }
+
+        return result;
+}
+
+static void
+itty_bit_string_sparse_apply_to_words (itty_bit_string_sparse_t           *sparse,
+                                       size_t                             *words,
+                                       size_t                              number_of_words,
+                                       itty_bit_string_sparse_operation_t  operation)
+{
+        assert (operation != ITTY_BIT_STRING_SPARSE_OPERATION_MASK);
+
+        for (size_t i = 0; i < sparse->number_of_containers; i++) {
+                itty_bit_string_container_t *container = &sparse->containers[i];
+
+                if (container->key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER >= number_of_words)
+                        break;
+
+                size_t *container_words = words + container->key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+                size_t container_number_of_words = itty_bit_string_sparse_get_container_number_of_words (container->key, number_of_words);
+                size_t bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+                const size_t *container_bitmap = bitmap;
+
+                if (container->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY) {
+                        for (size_t j = 0; j < container->size; j++) {
+                                uint16_t value = container->values[j];
+                                size_t bit = 1UL << (value % ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+
+                                if (operation == ITTY_BIT_STRING_SPARSE_OPERATION_COMBINE)
+                                        container_words[value / ITTY_BIT_STRING_WORD_SIZE_IN_BITS] |= bit;
+                                else
+                                        container_words[value / ITTY_BIT_STRING_WORD_SIZE_IN_BITS] ^= bit;
+                        }
+                        continue;
+                }
+
+                if (container->type == ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP)
+                        container_bitmap = container->words;
+                else
+                        itty_bit_string_container_get_bitmap (container, bitmap);
+
+                if (operation == ITTY_BIT_STRING_SPARSE_OPERATION_COMBINE) {
+                        for (size_t j = 0; j < container_number_of_words; j++)
+                                container_words[j] |= container_bitmap[j];
+                } else {
+                        for (size_t j = 0; j < container_number_of_words; j++)
+                                container_words[j] ^= container_bitmap[j];
+                }
+        }
+}
+
+void
+itty_bit_string_sparse_combine_into_words (itty_bit_string_sparse_t *sparse,
+                                           size_t                   *words,
+                                           size_t                    number_of_words)
+{
+        itty_bit_string_sparse_apply_to_words (sparse, words, number_of_words, ITTY_BIT_STRING_SPARSE_OPERATION_COMBINE);
+}
+
+void
+itty_bit_string_sparse_exclusive_or_into_words (itty_bit_string_sparse_t *sparse,
+                                                size_t                   *words,
+                                                size_t                    number_of_words)
+{
+        itty_bit_string_sparse_apply_to_words (sparse, words, number_of_words, ITTY_BIT_STRING_SPARSE_OPERATION_EXCLUSIVE_OR);
+}
+
+static size_t
+itty_bit_string_sparse_count_values_in_bitmap (itty_bit_string_container_t *container,
+                                               const size_t                *bitmap,
+                                               size_t                       number_of_words)
+{
+        size_t count = 0;
+
+        for (size_t i = 0; i < container->size; i++) {
+                uint16_t value = container->values[i];
+                size_t word_index = value / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+                if (word_index < number_of_words)
+                        count += (bitmap[word_index] >> (value % ITTY_BIT_STRING_WORD_SIZE_IN_BITS)) & 1;
+        }
+
+        return count;
+}
+
+size_t
+itty_bit_string_sparse_evaluate_overlap (itty_bit_string_sparse_t *a,
+                                         itty_bit_string_sparse_t *b)
+{
+        size_t overlap = 0;
+        size_t i = 0, j = 0;
+
+        while (i < a->number_of_containers && j < b->number_of_containers) {
+                itty_bit_string_container_t *a_container = &a->containers[i];
+                itty_bit_string_container_t *b_container = &b->containers[j];
+
+                if (a_container->key < b_container->key) {
+                        i++;
+                        continue;
+                }
+                if (b_container->key < a_container->key) {
+                        j++;
+                        continue;
+                }
+
+                if (a_container->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY && b_container->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY) {
+                        uint16_t values[ITTY_BIT_STRING_SPARSE_MAXIMUM_ARRAY_CARDINALITY];
+
+                        overlap += itty_bit_string_sparse_merge_values (a_container->values, a_container->size,
+                                                                        b_container->values, b_container->size,
+                                                                        ITTY_BIT_STRING_SPARSE_OPERATION_MASK, values);
+                } else if (a_container->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY || b_container->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY) {
+                        itty_bit_string_container_t *array_container = a_container->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY ? a_container : b_container;
+                        itty_bit_string_container_t *other_container = array_container == a_container ? b_container : a_container;
+                        size_t bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+
+                        itty_bit_string_container_get_bitmap (other_container, bitmap);
+                        overlap += itty_bit_string_sparse_count_values_in_bitmap (array_container, bitmap, ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER);
+                } else {
+                        size_t a_bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+                        size_t b_bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+
+                        itty_bit_string_container_get_bitmap (a_container, a_bitmap);
+                        itty_bit_string_container_get_bitmap (b_container, b_bitmap);
+                        for (size_t k = 0; k < ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER; k++)
+                                overlap += __builtin_popcountl (a_bitmap[k] & b_bitmap[k]);
+                }
+
+                i++;
+                j++;
+        }
+
+        return overlap;
+}
+
+size_t
+itty_bit_string_sparse_evaluate_overlap_with_words (itty_bit_string_sparse_t *sparse,
+                                                    const size_t             *words,
+                                                    size_t                    number_of_words)
+{
+        size_t overlap = 0;
+
+        for (size_t i = 0; i < sparse->number_of_containers; i++) {
+                itty_bit_string_container_t *container = &sparse->containers[i];
+
+                if (container->key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER >= number_of_words)
+                        break;
+
+                const size_t *container_words = words + container->key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+                size_t container_number_of_words = itty_bit_string_sparse_get_container_number_of_words (container->key, number_of_words);
+                size_t bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+                const size_t *container_bitmap = bitmap;
+
+                if (container->type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY) {
+                        overlap += itty_bit_string_sparse_count_values_in_bitmap (container, container_words, container_number_of_words);
+                        continue;
+                }
+
+                if (container->type == ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP)
+                        container_bitmap = container->words;
+                else
+                        itty_bit_string_container_get_bitmap (container, bitmap);
+
+                for (size_t j = 0; j < container_number_of_words; j++)
+                        overlap += __builtin_popcountl (container_bitmap[j] & container_words[j]);
+        }
+
+        return overlap;
+}
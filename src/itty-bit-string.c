@@ -1,6 +1,7 @@
 #include "itty-bit-string.h"
 #include "itty-bit-string-private.h"
 #include "itty-bit-string-list.h"
+#include "itty-bit-string-kernels-private.h"
 #include <assert.h>
 #include <limits.h>
 #include <stdio.h>
@@ -13,124 +14,699 @@
 #include <fcntl.h>
 #include <unistd.h>
 
-itty_bit_string_t *
-itty_bit_string_new (itty_bit_string_mutability_t mutability)
+static itty_bit_string_t *
+itty_bit_string_new_in_arena (itty_arena_t                 *arena,
+                              itty_bit_string_mutability_t  mutability)
 {
-        itty_bit_string_t *bit_string = malloc (sizeof (itty_bit_string_t));
+        itty_bit_string_t *bit_string;
+
+        if (arena != NULL)
+                bit_string = itty_arena_allocate (arena, sizeof (itty_bit_string_t));
+        else
+                bit_string = malloc (sizeof (itty_bit_string_t));
+
+        bit_string->arena = arena;
+        bit_string->parent = NULL;
+        bit_string->sparse = NULL;
+        atomic_init (&bit_string->reference_count, 1);
         bit_string->words = NULL;
         bit_string->number_of_words = 0;
+        bit_string->capacity = 0;
         bit_string->pop_count = 0;
         bit_string->pop_count_computed = false;
         bit_string->bit_length = 0;
         bit_string->bit_length_computed = false;
+        bit_string->hash = 0;
+        bit_string->hash_computed = false;
+        bit_string->aligned = false;
         bit_string->mutability = mutability;
         return bit_string;
 }
 
+itty_bit_string_t *
+itty_bit_string_new (itty_bit_string_mutability_t mutability)
+{
+        return itty_bit_string_new_in_arena (itty_arena_get_thread_default (), mutability);
+}
+
+itty_bit_string_t *
+itty_bit_string_new_aligned (itty_bit_string_mutability_t mutability)
+{
+        itty_bit_string_t *bit_string = itty_bit_string_new (mutability);
+        bit_string->aligned = true;
+        return bit_string;
+}
+
+bool
+itty_bit_string_is_aligned (itty_bit_string_t *bit_string)
+{
+        return bit_string->aligned;
+}
+
+/* Shared strings are always dense */
+itty_bit_string_t *
+itty_bit_string_ref (itty_bit_string_t *bit_string)
+{
+        itty_bit_string_make_dense (bit_string);
+        atomic_fetch_add_explicit (&bit_string->reference_count, 1, memory_order_relaxed);
+        return bit_string;
+}
+
 void
-itty_bit_string_free (itty_bit_string_t *bit_string)
+itty_bit_string_unref (itty_bit_string_t *bit_string)
 {
         if (!bit_string) {
                 return;
         }
-        if (bit_string->mutability == ITTY_BIT_STRING_MUTABILITY_READ_WRITE) {
-                free (bit_string->words);
+        if (atomic_fetch_sub_explicit (&bit_string->reference_count, 1, memory_order_acq_rel) > 1) {
+                return;
         }
-        free (bit_string);
+
+        itty_bit_string_t *parent = bit_string->parent;
+
+        if (bit_string->arena == NULL) {
+                if (bit_string->mutability == ITTY_BIT_STRING_MUTABILITY_READ_WRITE &&
+                    bit_string->words != bit_string->inline_words) {
+                        free (bit_string->words);
+                }
+                itty_bit_string_sparse_free (bit_string->sparse);
+                free (bit_string);
+        }
+
+        itty_bit_string_unref (parent);
 }
 
 void
-itty_bit_string_append_word (itty_bit_string_t *bit_string,
-                             size_t             word)
+itty_bit_string_free (itty_bit_string_t *bit_string)
 {
-        assert (bit_string->mutability != ITTY_BIT_STRING_MUTABILITY_READ_ONLY);
+        itty_bit_string_unref (bit_string);
+}
+
+/* Views hold the storage, not the string, so writing to the string copies it away from them */
+static itty_bit_string_t *
+itty_bit_string_share_storage (itty_bit_string_t *bit_string)
+{
+        if (bit_string->parent != NULL)
+                return bit_string->parent;
+
+        if (bit_string->mutability != ITTY_BIT_STRING_MUTABILITY_READ_WRITE)
+                return bit_string;
+
+        itty_bit_string_t *storage = itty_bit_string_new_in_arena (bit_string->arena, ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+        if (bit_string->words == bit_string->inline_words) {
+                memcpy (storage->inline_words, bit_string->inline_words, sizeof (storage->inline_words));
+                storage->words = storage->inline_words;
+        } else {
+                storage->words = bit_string->words;
+        }
+
+        storage->number_of_words = bit_string->number_of_words;
+        storage->capacity = bit_string->capacity;
+        storage->aligned = bit_string->aligned;
+
+        bit_string->words = storage->words;
+        bit_string->capacity = 0;
+        bit_string->mutability = ITTY_BIT_STRING_MUTABILITY_COPY_ON_WRITE;
+        bit_string->parent = storage;
+
+        return storage;
+}
+
+itty_bit_string_t *
+itty_bit_string_new_view (itty_bit_string_t *bit_string,
+                          size_t             word_offset,
+                          size_t             number_of_words)
+{
+        itty_bit_string_make_dense (bit_string);
+
+        assert (word_offset <= bit_string->number_of_words);
+        assert (number_of_words <= bit_string->number_of_words - word_offset);
+
+        itty_bit_string_t *parent = itty_bit_string_share_storage (bit_string);
+        itty_bit_string_mutability_t mutability = ITTY_BIT_STRING_MUTABILITY_COPY_ON_WRITE;
+
+        if (bit_string->mutability == ITTY_BIT_STRING_MUTABILITY_READ_ONLY)
+                mutability = ITTY_BIT_STRING_MUTABILITY_READ_ONLY;
+
+        itty_bit_string_t *view = itty_bit_string_new (mutability);
+        view->words = bit_string->words + word_offset;
+        view->number_of_words = number_of_words;
+        view->parent = itty_bit_string_ref (parent);
+
+        if (word_offset == 0 && number_of_words == bit_string->number_of_words) {
+                view->pop_count = bit_string->pop_count;
+                view->pop_count_computed = bit_string->pop_count_computed;
+                view->bit_length = bit_string->bit_length;
+                view->bit_length_computed = bit_string->bit_length_computed;
+                view->hash = bit_string->hash;
+                view->hash_computed = bit_string->hash_computed;
+        }
+
+        return view;
+}
+
+void
+itty_bit_string_copy_words (itty_bit_string_t *bit_string,
+                            size_t            *words,
+                            size_t             number_of_words)
+{
+        assert (number_of_words <= bit_string->number_of_words);
+
+        if (bit_string->sparse != NULL)
+                itty_bit_string_sparse_get_words (bit_string->sparse, words, number_of_words);
+        else if (number_of_words > 0)
+                memcpy (words, bit_string->words, number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+}
+
+itty_bit_string_t *
+itty_bit_string_copy (itty_bit_string_t *bit_string)
+{
+        itty_bit_string_t *copy = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+        copy->aligned = bit_string->aligned;
+
+        if (bit_string->number_of_words > 0) {
+                itty_bit_string_reserve (copy, bit_string->number_of_words);
+                itty_bit_string_copy_words (bit_string, copy->words, bit_string->number_of_words);
+                copy->number_of_words = bit_string->number_of_words;
+        }
+
+        copy->pop_count = bit_string->pop_count;
+        copy->pop_count_computed = bit_string->pop_count_computed;
+        copy->bit_length = bit_string->bit_length;
+        copy->bit_length_computed = bit_string->bit_length_computed;
+        copy->hash = bit_string->hash;
+        copy->hash_computed = bit_string->hash_computed;
+
+        return copy;
+}
+
+/* Sparse strings are read through a dense copy, so they stay sparse */
+static itty_bit_string_t *
+itty_bit_string_borrow_dense (itty_bit_string_t *bit_string)
+{
+        if (bit_string->sparse == NULL)
+                return bit_string;
+
+        return itty_bit_string_copy (bit_string);
+}
+
+static void
+itty_bit_string_release_dense (itty_bit_string_t *bit_string,
+                               itty_bit_string_t *dense)
+{
+        if (dense != bit_string)
+                itty_bit_string_free (dense);
+}
+
+static void
+itty_bit_string_set_capacity (itty_bit_string_t *bit_string,
+                              size_t             capacity)
+{
+        size_t *words = bit_string->words;
+        bool owns_words = bit_string->mutability == ITTY_BIT_STRING_MUTABILITY_READ_WRITE;
+        bool owns_heap_words = owns_words && words != NULL && words != bit_string->inline_words && bit_string->arena == NULL;
+
+        if (owns_heap_words && !bit_string->aligned) {
+                bit_string->words = realloc (words, capacity * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                bit_string->capacity = capacity;
+                return;
+        }
+
+        if (bit_string->aligned) {
+                capacity = (capacity + ITTY_BIT_STRING_WORDS_PER_ALIGNMENT - 1) & ~(ITTY_BIT_STRING_WORDS_PER_ALIGNMENT - 1);
+
+                if (bit_string->arena != NULL)
+                        bit_string->words = itty_arena_allocate_aligned (bit_string->arena, capacity * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES, ITTY_BIT_STRING_ALIGNMENT);
+                else
+                        bit_string->words = aligned_alloc (ITTY_BIT_STRING_ALIGNMENT, capacity * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                bit_string->capacity = capacity;
+        } else if (capacity <= ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS) {
+                bit_string->words = bit_string->inline_words;
+                bit_string->capacity = ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS;
+        } else if (bit_string->arena != NULL) {
+                bit_string->words = itty_arena_allocate (bit_string->arena, capacity * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                bit_string->capacity = capacity;
+        } else {
+                bit_string->words = malloc (capacity * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                bit_string->capacity = capacity;
+        }
+
+        if (words != NULL && words != bit_string->words)
+                memcpy (bit_string->words, words, bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+
+        if (bit_string->aligned)
+                memset (bit_string->words + bit_string->number_of_words, 0, (capacity - bit_string->number_of_words) * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+
+        if (owns_heap_words)
+                free (words);
+
+        bit_string->mutability = ITTY_BIT_STRING_MUTABILITY_READ_WRITE;
+
+        if (bit_string->parent != NULL) {
+                itty_bit_string_unref (bit_string->parent);
+                bit_string->parent = NULL;
+        }
+}
+
+void
+itty_bit_string_make_dense (itty_bit_string_t *bit_string)
+{
+        itty_bit_string_sparse_t *sparse = bit_string->sparse;
+        size_t number_of_words = bit_string->number_of_words;
+
+        if (sparse == NULL)
+                return;
+
+        assert (atomic_load_explicit (&bit_string->reference_count, memory_order_relaxed) == 1);
+
+        bit_string->sparse = NULL;
+        bit_string->number_of_words = 0;
+        itty_bit_string_set_capacity (bit_string, number_of_words);
+        bit_string->number_of_words = number_of_words;
+        itty_bit_string_sparse_get_words (sparse, bit_string->words, number_of_words);
+        itty_bit_string_sparse_free (sparse);
+}
+
+/* Sparse readers decode at most one container at a time */
+static const size_t itty_bit_string_zero_words[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
 
-        if (bit_string->mutability == ITTY_BIT_STRING_MUTABILITY_COPY_ON_WRITE) {
-                bit_string->mutability = ITTY_BIT_STRING_MUTABILITY_READ_WRITE;
-                size_t *words = bit_string->words;
-                bit_string->words = malloc ((bit_string->number_of_words + 1) * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
-                memcpy (bit_string->words, words, (bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES));
+static size_t
+itty_bit_string_get_number_of_stretches (itty_bit_string_t *bit_string)
+{
+        return (bit_string->number_of_words + ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER - 1) / ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+}
+
+static size_t
+itty_bit_string_get_stretch_number_of_words (itty_bit_string_t *bit_string,
+                                             size_t             key)
+{
+        size_t number_of_words = bit_string->number_of_words - key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+
+        return number_of_words < ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER ? number_of_words : ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+}
+
+/* Keys must be visited in order, starting from container_index zero */
+static const size_t *
+itty_bit_string_get_stretch_words (itty_bit_string_t *bit_string,
+                                   size_t             key,
+                                   size_t            *container_index,
+                                   size_t            *bitmap)
+{
+        itty_bit_string_sparse_t *sparse = bit_string->sparse;
+
+        if (sparse == NULL)
+                return bit_string->words + key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER;
+
+        while (*container_index < sparse->number_of_containers && sparse->containers[*container_index].key < key)
+                (*container_index)++;
+
+        if (*container_index < sparse->number_of_containers && sparse->containers[*container_index].key == key)
+                return itty_bit_string_sparse_get_container_words (&sparse->containers[*container_index], bitmap);
 
+        return itty_bit_string_zero_words;
+}
+
+static size_t
+itty_bit_string_find_first_nonzero_word (const size_t *words,
+                                         size_t        number_of_words)
+{
+        size_t i = 0;
+
+        while (i < number_of_words && words[i] == 0)
+                i++;
+
+        return i;
+}
+
+static size_t
+itty_bit_string_find_leading_zeros (itty_bit_string_t *bit_string,
+                                    size_t            *leading_zeros)
+{
+        size_t first_nonzero_word;
+        size_t word = 0;
+
+        if (bit_string->sparse != NULL) {
+                first_nonzero_word = itty_bit_string_sparse_get_first_word (bit_string->sparse, bit_string->number_of_words, &word);
         } else {
-                bit_string->words = realloc (bit_string->words,
-                                             (bit_string->number_of_words + 1) * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                first_nonzero_word = itty_bit_string_find_first_nonzero_word (bit_string->words, bit_string->number_of_words);
+                if (first_nonzero_word < bit_string->number_of_words)
+                        word = bit_string->words[first_nonzero_word];
+        }
+
+        *leading_zeros = word != 0 ? __builtin_clzl (word) : 0;
+
+        return first_nonzero_word;
+}
+
+/* Strings go dense again at twice the density they go sparse at */
+#define ITTY_BIT_STRING_SPARSE_MINIMUM_NUMBER_OF_WORDS 64
+#define ITTY_BIT_STRING_SPARSE_DENSITY 32
+
+static void
+itty_bit_string_set_sparse (itty_bit_string_t        *bit_string,
+                            itty_bit_string_sparse_t *sparse,
+                            size_t                    number_of_words)
+{
+        assert (bit_string->mutability != ITTY_BIT_STRING_MUTABILITY_READ_ONLY);
+        assert (atomic_load_explicit (&bit_string->reference_count, memory_order_relaxed) == 1);
+
+        itty_bit_string_sparse_free (bit_string->sparse);
+
+        if (bit_string->mutability == ITTY_BIT_STRING_MUTABILITY_READ_WRITE &&
+            bit_string->arena == NULL &&
+            bit_string->words != bit_string->inline_words)
+                free (bit_string->words);
+
+        if (bit_string->parent != NULL) {
+                itty_bit_string_unref (bit_string->parent);
+                bit_string->parent = NULL;
         }
+
+        bit_string->words = NULL;
+        bit_string->capacity = 0;
+        bit_string->mutability = ITTY_BIT_STRING_MUTABILITY_READ_WRITE;
+        bit_string->sparse = sparse;
+        bit_string->number_of_words = number_of_words;
+        bit_string->pop_count = sparse->cardinality;
+        bit_string->pop_count_computed = true;
+        bit_string->bit_length_computed = false;
+        bit_string->hash_computed = false;
+
+        if (sparse->cardinality * ITTY_BIT_STRING_SPARSE_DENSITY / 2 >= number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS)
+                itty_bit_string_make_dense (bit_string);
+}
+
+static void
+itty_bit_string_make_sparse_if_worthwhile (itty_bit_string_t *bit_string)
+{
+        if (bit_string->sparse != NULL ||
+            bit_string->number_of_words < ITTY_BIT_STRING_SPARSE_MINIMUM_NUMBER_OF_WORDS ||
+            bit_string->mutability != ITTY_BIT_STRING_MUTABILITY_READ_WRITE ||
+            bit_string->parent != NULL ||
+            atomic_load_explicit (&bit_string->reference_count, memory_order_relaxed) != 1)
+                return;
+
+        if (itty_bit_string_get_pop_count (bit_string) * ITTY_BIT_STRING_SPARSE_DENSITY >= bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS)
+                return;
+
+        itty_bit_string_set_sparse (bit_string,
+                                    itty_bit_string_sparse_new_from_words (bit_string->arena, bit_string->words, bit_string->number_of_words),
+                                    bit_string->number_of_words);
+}
+
+bool
+itty_bit_string_is_sparse (itty_bit_string_t *bit_string)
+{
+        return bit_string->sparse != NULL;
+}
+
+void
+itty_bit_string_reserve (itty_bit_string_t *bit_string,
+                         size_t             number_of_words)
+{
+        assert (bit_string->mutability != ITTY_BIT_STRING_MUTABILITY_READ_ONLY);
+
+        itty_bit_string_make_dense (bit_string);
+
+        if (number_of_words < bit_string->number_of_words)
+                number_of_words = bit_string->number_of_words;
+
+        if (number_of_words > bit_string->capacity)
+                itty_bit_string_set_capacity (bit_string, number_of_words);
+}
+
+static void
+itty_bit_string_grow_storage (itty_bit_string_t *bit_string,
+                              size_t             number_of_words)
+{
+        assert (bit_string->mutability != ITTY_BIT_STRING_MUTABILITY_READ_ONLY);
+        assert (atomic_load_explicit (&bit_string->reference_count, memory_order_relaxed) == 1);
+
+        itty_bit_string_make_dense (bit_string);
+
+        if (number_of_words <= bit_string->capacity)
+                return;
+
+        size_t capacity = bit_string->capacity * 2;
+        if (capacity < number_of_words)
+                capacity = number_of_words;
+        if (capacity < bit_string->number_of_words)
+                capacity = bit_string->number_of_words;
+
+        itty_bit_string_set_capacity (bit_string, capacity);
+}
+
+void
+itty_bit_string_append_word (itty_bit_string_t *bit_string,
+                             size_t             word)
+{
+        itty_bit_string_grow_storage (bit_string, bit_string->number_of_words + 1);
         bit_string->words[bit_string->number_of_words] = word;
         bit_string->number_of_words++;
         bit_string->pop_count_computed = false;
         bit_string->bit_length_computed = false;
+        bit_string->hash_computed = false;
 }
 
 void
 itty_bit_string_append_zeros (itty_bit_string_t *bit_string,
                               size_t             count)
 {
-        assert (bit_string->mutability != ITTY_BIT_STRING_MUTABILITY_READ_ONLY);
+        itty_bit_string_grow_storage (bit_string, bit_string->number_of_words + count);
+        memset (bit_string->words + bit_string->number_of_words, 0, count * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        bit_string->number_of_words += count;
+        bit_string->pop_count_computed = false;
+        bit_string->bit_length_computed = false;
+        bit_string->hash_computed = false;
+}
 
-        for (size_t i = 0; i < count; i++) {
-                itty_bit_string_append_word (bit_string, 0);
-        }
+static void
+itty_bit_string_prepare_destination (itty_bit_string_t *bit_string,
+                                     size_t             number_of_words)
+{
+        itty_bit_string_sparse_free (bit_string->sparse);
+        bit_string->sparse = NULL;
+
+        itty_bit_string_grow_storage (bit_string, number_of_words);
+
+        bit_string->number_of_words = number_of_words;
+        bit_string->pop_count_computed = false;
+        bit_string->bit_length_computed = false;
+        bit_string->hash_computed = false;
 }
 
-itty_bit_string_t *
-itty_bit_string_exclusive_nor (itty_bit_string_t *a,
-                               itty_bit_string_t *b)
+static const itty_bit_string_kernels_t *
+itty_bit_string_get_kernels_for_operands (itty_bit_string_t *a,
+                                          itty_bit_string_t *b)
 {
-        size_t max_number_of_words;
+        size_t min_number_of_words = a->number_of_words > b->number_of_words ? b->number_of_words : a->number_of_words;
 
-        if (a->number_of_words > b->number_of_words)
-                max_number_of_words = a->number_of_words;
-        else
+        return itty_bit_string_kernels_get_for_width (min_number_of_words);
+}
+
+/* Aligned operands of equal width run the kernels over their padding too */
+static size_t
+itty_bit_string_get_kernel_number_of_words (itty_bit_string_t *result,
+                                            itty_bit_string_t *a,
+                                            itty_bit_string_t *b)
+{
+        size_t min_number_of_words = a->number_of_words > b->number_of_words ? b->number_of_words : a->number_of_words;
+
+        if (!result->aligned || !a->aligned || !b->aligned || a->number_of_words != b->number_of_words)
+                return min_number_of_words;
+
+        return (min_number_of_words + ITTY_BIT_STRING_WORDS_PER_ALIGNMENT - 1) & ~(ITTY_BIT_STRING_WORDS_PER_ALIGNMENT - 1);
+}
+
+typedef enum {
+        ITTY_BIT_STRING_TAIL_COPY,
+        ITTY_BIT_STRING_TAIL_INVERT,
+        ITTY_BIT_STRING_TAIL_ZERO,
+} itty_bit_string_tail_t;
+
+static void
+itty_bit_string_apply_binary_kernel (itty_bit_string_t               *result,
+                                     itty_bit_string_t               *a,
+                                     itty_bit_string_t               *b,
+                                     itty_bit_string_binary_kernel_t  kernel,
+                                     size_t                           kernel_number_of_words,
+                                     itty_bit_string_tail_t           tail)
+{
+        itty_bit_string_t *dense_a = itty_bit_string_borrow_dense (a);
+        itty_bit_string_t *dense_b = itty_bit_string_borrow_dense (b);
+        itty_bit_string_t *longer = dense_a;
+        size_t min_number_of_words = b->number_of_words;
+        size_t max_number_of_words = a->number_of_words;
+
+        if (b->number_of_words > a->number_of_words) {
+                longer = dense_b;
+                min_number_of_words = a->number_of_words;
                 max_number_of_words = b->number_of_words;
+        }
 
-        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
-        result->number_of_words = max_number_of_words;
-        result->words = malloc (result->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        itty_bit_string_prepare_destination (result, max_number_of_words);
+
+        kernel (result->words, dense_a->words, dense_b->words, kernel_number_of_words);
+
+        size_t *tail_words = result->words + min_number_of_words;
+        size_t *longer_tail_words = longer->words + min_number_of_words;
+        size_t tail_number_of_words = max_number_of_words - min_number_of_words;
+
+        switch (tail) {
+        case ITTY_BIT_STRING_TAIL_COPY:
+                if (tail_words != longer_tail_words)
+                        memmove (tail_words, longer_tail_words, tail_number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                break;
+        case ITTY_BIT_STRING_TAIL_INVERT:
+                for (size_t i = 0; i < tail_number_of_words; i++)
+                        tail_words[i] = ~longer_tail_words[i];
+                break;
+        case ITTY_BIT_STRING_TAIL_ZERO:
+                memset (tail_words, 0, tail_number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                break;
+        }
+
+        itty_bit_string_release_dense (a, dense_a);
+        itty_bit_string_release_dense (b, dense_b);
+}
+
+/* Sparse operands of mismatched widths go through the dense kernels */
+static bool
+itty_bit_string_has_sparse_operands (itty_bit_string_t *a,
+                                     itty_bit_string_t *b)
+{
+        return (a->sparse != NULL || b->sparse != NULL) && a->number_of_words == b->number_of_words;
+}
+
+static void
+itty_bit_string_apply_sparse_to_words (itty_bit_string_t *result,
+                                       itty_bit_string_t *a,
+                                       itty_bit_string_t *b,
+                                       void             (*apply) (itty_bit_string_sparse_t *sparse,
+                                                                  size_t                   *words,
+                                                                  size_t                    number_of_words))
+{
+        itty_bit_string_t *sparse_operand = a->sparse != NULL ? a : b;
+        itty_bit_string_t *dense_operand = a->sparse != NULL ? b : a;
+        itty_bit_string_sparse_t *sparse = sparse_operand->sparse;
+        size_t number_of_words = dense_operand->number_of_words;
+
+        if (result == sparse_operand)
+                result->sparse = NULL;
 
-        for (size_t i = 0; i < max_number_of_words; i++) {
-                size_t a_word = 0;
-                size_t b_word = 0;
+        itty_bit_string_prepare_destination (result, number_of_words);
 
-                if (i < a->number_of_words)
-                        a_word = a->words[i];
+        if (result->words != dense_operand->words)
+                memmove (result->words, dense_operand->words, number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
 
-                if (i < b->number_of_words)
-                        b_word = b->words[i];
+        apply (sparse, result->words, number_of_words);
 
-                result->words[i] = ~(a_word ^ b_word);
+        if (result == sparse_operand)
+                itty_bit_string_sparse_free (sparse);
+}
+
+void
+itty_bit_string_exclusive_nor_into (itty_bit_string_t *result,
+                                    itty_bit_string_t *a,
+                                    itty_bit_string_t *b)
+{
+        size_t number_of_words = itty_bit_string_get_kernel_number_of_words (result, a, b);
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get_for_width (number_of_words);
+
+        itty_bit_string_apply_binary_kernel (result, a, b, kernels->exclusive_nor, number_of_words, ITTY_BIT_STRING_TAIL_INVERT);
+}
+
+void
+itty_bit_string_exclusive_or_into (itty_bit_string_t *result,
+                                   itty_bit_string_t *a,
+                                   itty_bit_string_t *b)
+{
+        if (itty_bit_string_has_sparse_operands (a, b)) {
+                if (a->sparse != NULL && b->sparse != NULL)
+                        itty_bit_string_set_sparse (result, itty_bit_string_sparse_exclusive_or (result->arena, a->sparse, b->sparse), a->number_of_words);
+                else
+                        itty_bit_string_apply_sparse_to_words (result, a, b, itty_bit_string_sparse_exclusive_or_into_words);
+                return;
         }
 
-        return result;
+        size_t number_of_words = itty_bit_string_get_kernel_number_of_words (result, a, b);
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get_for_width (number_of_words);
+
+        itty_bit_string_apply_binary_kernel (result, a, b, kernels->exclusive_or, number_of_words, ITTY_BIT_STRING_TAIL_COPY);
 }
 
-itty_bit_string_t *
-itty_bit_string_exclusive_or (itty_bit_string_t *a,
+void
+itty_bit_string_combine_into (itty_bit_string_t *result,
+                              itty_bit_string_t *a,
                               itty_bit_string_t *b)
 {
-        size_t max_number_of_words;
-
-        if (a->number_of_words > b->number_of_words)
-                max_number_of_words = a->number_of_words;
-        else
-                max_number_of_words = b->number_of_words;
+        if (itty_bit_string_has_sparse_operands (a, b)) {
+                if (a->sparse != NULL && b->sparse != NULL)
+                        itty_bit_string_set_sparse (result, itty_bit_string_sparse_combine (result->arena, a->sparse, b->sparse), a->number_of_words);
+                else
+                        itty_bit_string_apply_sparse_to_words (result, a, b, itty_bit_string_sparse_combine_into_words);
+                return;
+        }
 
-        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
-        result->number_of_words = max_number_of_words;
-        result->words = malloc (result->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        size_t number_of_words = itty_bit_string_get_kernel_number_of_words (result, a, b);
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get_for_width (number_of_words);
 
-        for (size_t i = 0; i < max_number_of_words; i++) {
-                size_t a_word = 0;
-                size_t b_word = 0;
+        itty_bit_string_apply_binary_kernel (result, a, b, kernels->combine, number_of_words, ITTY_BIT_STRING_TAIL_COPY);
+}
 
-                if (i < a->number_of_words)
-                        a_word = a->words[i];
+void
+itty_bit_string_mask_into (itty_bit_string_t *result,
+                           itty_bit_string_t *a,
+                           itty_bit_string_t *b)
+{
+        if (itty_bit_string_has_sparse_operands (a, b)) {
+                itty_bit_string_sparse_t *sparse;
 
-                if (i < b->number_of_words)
-                        b_word = b->words[i];
+                if (a->sparse != NULL && b->sparse != NULL)
+                        sparse = itty_bit_string_sparse_mask (result->arena, a->sparse, b->sparse);
+                else if (a->sparse != NULL)
+                        sparse = itty_bit_string_sparse_mask_words (result->arena, a->sparse, b->words, b->number_of_words);
+                else
+                        sparse = itty_bit_string_sparse_mask_words (result->arena, b->sparse, a->words, a->number_of_words);
 
-                result->words[i] = a_word ^ b_word;
+                itty_bit_string_set_sparse (result, sparse, a->number_of_words);
+                return;
         }
 
+        size_t number_of_words = itty_bit_string_get_kernel_number_of_words (result, a, b);
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get_for_width (number_of_words);
+
+        itty_bit_string_apply_binary_kernel (result, a, b, kernels->mask, number_of_words, ITTY_BIT_STRING_TAIL_ZERO);
+}
+
+static itty_bit_string_t *
+itty_bit_string_new_for_operands (itty_bit_string_t *a,
+                                  itty_bit_string_t *b)
+{
+        if (a->aligned && b->aligned)
+                return itty_bit_string_new_aligned (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+        return itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+}
+
+itty_bit_string_t *
+itty_bit_string_exclusive_nor (itty_bit_string_t *a,
+                               itty_bit_string_t *b)
+{
+        itty_bit_string_t *result = itty_bit_string_new_for_operands (a, b);
+        itty_bit_string_exclusive_nor_into (result, a, b);
+        return result;
+}
+
+itty_bit_string_t *
+itty_bit_string_exclusive_or (itty_bit_string_t *a,
+                              itty_bit_string_t *b)
+{
+        itty_bit_string_t *result = itty_bit_string_new_for_operands (a, b);
+        itty_bit_string_exclusive_or_into (result, a, b);
+        itty_bit_string_make_sparse_if_worthwhile (result);
         return result;
 }
 
@@ -138,104 +714,264 @@ itty_bit_string_t *
 itty_bit_string_combine (itty_bit_string_t *a,
                          itty_bit_string_t *b)
 {
-        size_t max_number_of_words;
+        itty_bit_string_t *result = itty_bit_string_new_for_operands (a, b);
+        itty_bit_string_combine_into (result, a, b);
+        return result;
+}
 
-        if (a->number_of_words > b->number_of_words)
-                max_number_of_words = a->number_of_words;
-        else
-                max_number_of_words = b->number_of_words;
+itty_bit_string_t *
+itty_bit_string_mask (itty_bit_string_t *a,
+                      itty_bit_string_t *b)
+{
+        itty_bit_string_t *result = itty_bit_string_new_for_operands (a, b);
+        itty_bit_string_mask_into (result, a, b);
+        itty_bit_string_make_sparse_if_worthwhile (result);
+        return result;
+}
 
-        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
-        result->number_of_words = max_number_of_words;
-        result->words = malloc (result->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+size_t
+itty_bit_string_get_pop_count (itty_bit_string_t *bit_string)
+{
+        if (!bit_string->pop_count_computed) {
+                const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get_for_width (bit_string->number_of_words);
+                bit_string->pop_count = kernels->pop_count (bit_string->words, bit_string->number_of_words);
+                bit_string->pop_count_computed = true;
+        }
+        return bit_string->pop_count;
+}
 
-        for (size_t i = 0; i < max_number_of_words; i++) {
-                size_t a_word = 0;
-                size_t b_word = 0;
+#define ITTY_BIT_STRING_HASH_PRIME_1 0x9e3779b185ebca87ULL
+#define ITTY_BIT_STRING_HASH_PRIME_2 0xc2b2ae3d27d4eb4fULL
+#define ITTY_BIT_STRING_HASH_PRIME_3 0x165667b19e3779f9ULL
+#define ITTY_BIT_STRING_HASH_PRIME_4 0x85ebca77c2b2ae63ULL
+#define ITTY_BIT_STRING_HASH_PRIME_5 0x27d4eb2f165667c5ULL
 
-                if (i < a->number_of_words)
-                        a_word = a->words[i];
+static inline uint64_t
+itty_bit_string_hash_round (uint64_t accumulator,
+                            uint64_t word)
+{
+        accumulator += word * ITTY_BIT_STRING_HASH_PRIME_2;
+        accumulator = (accumulator << 31) | (accumulator >> 33);
+        return accumulator * ITTY_BIT_STRING_HASH_PRIME_1;
+}
 
-                if (i < b->number_of_words)
-                        b_word = b->words[i];
+static inline uint64_t
+itty_bit_string_hash_merge_round (uint64_t hash,
+                                  uint64_t accumulator)
+{
+        hash ^= itty_bit_string_hash_round (0, accumulator);
+        return hash * ITTY_BIT_STRING_HASH_PRIME_1 + ITTY_BIT_STRING_HASH_PRIME_4;
+}
+
+static inline uint64_t
+itty_bit_string_rotate_hash (uint64_t hash,
+                             int      count)
+{
+        return (hash << count) | (hash >> (64 - count));
+}
+
+/* XXH64 over the words as they sit in memory */
+typedef struct {
+        uint64_t accumulators[4];
+        uint64_t hash;
+        size_t   number_of_words;
+        size_t   number_of_striped_words;
+        size_t   index;
+} itty_bit_string_hash_state_t;
+
+static void
+itty_bit_string_hash_state_init (itty_bit_string_hash_state_t *state,
+                                 size_t                        number_of_words)
+{
+        state->accumulators[0] = ITTY_BIT_STRING_HASH_PRIME_1 + ITTY_BIT_STRING_HASH_PRIME_2;
+        state->accumulators[1] = ITTY_BIT_STRING_HASH_PRIME_2;
+        state->accumulators[2] = 0;
+        state->accumulators[3] = -ITTY_BIT_STRING_HASH_PRIME_1;
+        state->hash = ITTY_BIT_STRING_HASH_PRIME_5 + number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES;
+        state->number_of_words = number_of_words;
+        state->number_of_striped_words = number_of_words >= 4 ? number_of_words & ~(size_t) 3 : 0;
+        state->index = 0;
+}
+
+static void
+itty_bit_string_hash_state_merge_stripes (itty_bit_string_hash_state_t *state)
+{
+        if (state->number_of_striped_words == 0 || state->index != state->number_of_striped_words)
+                return;
+
+        uint64_t hash = itty_bit_string_rotate_hash (state->accumulators[0], 1) +
+                        itty_bit_string_rotate_hash (state->accumulators[1], 7) +
+                        itty_bit_string_rotate_hash (state->accumulators[2], 12) +
+                        itty_bit_string_rotate_hash (state->accumulators[3], 18);
+
+        for (size_t lane = 0; lane < 4; lane++)
+                hash = itty_bit_string_hash_merge_round (hash, state->accumulators[lane]);
+
+        state->hash = hash + state->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES;
+}
 
-                result->words[i] = a_word | b_word;
+static void
+itty_bit_string_hash_state_add_words (itty_bit_string_hash_state_t *state,
+                                      const size_t                 *words,
+                                      size_t                        number_of_words)
+{
+        size_t i = 0;
+
+        if (state->index % 4 == 0 && state->index < state->number_of_striped_words) {
+                size_t number_of_stripes = (state->number_of_striped_words - state->index) / 4;
+
+                if (number_of_stripes > number_of_words / 4)
+                        number_of_stripes = number_of_words / 4;
+
+                for (; i < number_of_stripes * 4; i += 4) {
+                        for (size_t lane = 0; lane < 4; lane++)
+                                state->accumulators[lane] = itty_bit_string_hash_round (state->accumulators[lane], words[i + lane]);
+                }
+
+                state->index += i;
         }
 
-        return result;
+        for (; i < number_of_words; i++, state->index++) {
+                if (state->index < state->number_of_striped_words) {
+                        state->accumulators[state->index % 4] = itty_bit_string_hash_round (state->accumulators[state->index % 4], words[i]);
+                        continue;
+                }
+
+                itty_bit_string_hash_state_merge_stripes (state);
+                state->hash ^= itty_bit_string_hash_round (0, words[i]);
+                state->hash = itty_bit_string_rotate_hash (state->hash, 27) * ITTY_BIT_STRING_HASH_PRIME_1 + ITTY_BIT_STRING_HASH_PRIME_4;
+        }
 }
 
-itty_bit_string_t *
-itty_bit_string_mask (itty_bit_string_t *a,
-                      itty_bit_string_t *b)
+static uint64_t
+itty_bit_string_hash_state_finish (itty_bit_string_hash_state_t *state)
 {
-        size_t max_number_of_words;
+        itty_bit_string_hash_state_merge_stripes (state);
 
-        if (a->number_of_words > b->number_of_words)
-                max_number_of_words = a->number_of_words;
-        else
-                max_number_of_words = b->number_of_words;
+        uint64_t hash = state->hash;
 
-        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
-        result->number_of_words = max_number_of_words;
-        result->words = malloc (result->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        hash ^= hash >> 33;
+        hash *= ITTY_BIT_STRING_HASH_PRIME_2;
+        hash ^= hash >> 29;
+        hash *= ITTY_BIT_STRING_HASH_PRIME_3;
+        hash ^= hash >> 32;
 
-        for (size_t i = 0; i < max_number_of_words; i++) {
-                size_t a_word = 0;
-                size_t b_word = 0;
+        return hash;
+}
 
-                if (i < a->number_of_words)
-                        a_word = a->words[i];
+uint64_t
+itty_bit_string_get_hash (itty_bit_string_t *bit_string)
+{
+        if (!bit_string->hash_computed) {
+                itty_bit_string_hash_state_t state;
+                size_t bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+                size_t container_index = 0;
+
+                itty_bit_string_hash_state_init (&state, bit_string->number_of_words);
+                for (size_t key = 0; key < itty_bit_string_get_number_of_stretches (bit_string); key++)
+                        itty_bit_string_hash_state_add_words (&state,
+                                                              itty_bit_string_get_stretch_words (bit_string, key, &container_index, bitmap),
+                                                              itty_bit_string_get_stretch_number_of_words (bit_string, key));
+
+                bit_string->hash = itty_bit_string_hash_state_finish (&state);
+                bit_string->hash_computed = true;
+        }
+        return bit_string->hash;
+}
 
-                if (i < b->number_of_words)
-                        b_word = b->words[i];
+size_t
+itty_bit_string_get_length (itty_bit_string_t *bit_string)
+{
+        if (!bit_string->bit_length_computed) {
+                size_t leading_zeros;
+                size_t first_nonzero_word = itty_bit_string_find_leading_zeros (bit_string, &leading_zeros);
 
-                result->words[i] = a_word & b_word;
+                bit_string->bit_length = 0;
+                if (first_nonzero_word < bit_string->number_of_words)
+                        bit_string->bit_length = (bit_string->number_of_words - first_nonzero_word) * ITTY_BIT_STRING_WORD_SIZE_IN_BITS - leading_zeros;
+                bit_string->bit_length_computed = true;
         }
+        return bit_string->bit_length;
+}
 
-        return result;
+static size_t
+itty_bit_string_evaluate_sparse_overlap (itty_bit_string_t *a,
+                                         itty_bit_string_t *b)
+{
+        if (a->sparse != NULL && b->sparse != NULL)
+                return itty_bit_string_sparse_evaluate_overlap (a->sparse, b->sparse);
+        if (a->sparse != NULL)
+                return itty_bit_string_sparse_evaluate_overlap_with_words (a->sparse, b->words, b->number_of_words);
+        return itty_bit_string_sparse_evaluate_overlap_with_words (b->sparse, a->words, a->number_of_words);
+}
+
+static size_t
+itty_bit_string_evaluate_sparse_distance (itty_bit_string_t *a,
+                                          itty_bit_string_t *b)
+{
+        return itty_bit_string_get_pop_count (a) + itty_bit_string_get_pop_count (b) - 2 * itty_bit_string_evaluate_sparse_overlap (a, b);
 }
 
 size_t
-itty_bit_string_get_pop_count (itty_bit_string_t *bit_string)
+itty_bit_string_evaluate_similarity (itty_bit_string_t *a,
+                                     itty_bit_string_t *b)
 {
-        if (!bit_string->pop_count_computed) {
-                bit_string->pop_count = 0;
-                for (size_t i = 0; i < bit_string->number_of_words; i++) {
-                        bit_string->pop_count += __builtin_popcountl (bit_string->words[i]);
-                }
-                bit_string->pop_count_computed = true;
+        if (a->sparse != NULL || b->sparse != NULL) {
+                size_t max_number_of_words = a->number_of_words > b->number_of_words ? a->number_of_words : b->number_of_words;
+                return max_number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS - itty_bit_string_evaluate_sparse_distance (a, b);
         }
-        return bit_string->pop_count;
+
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_get_kernels_for_operands (a, b);
+        itty_bit_string_t *longer = a->number_of_words > b->number_of_words ? a : b;
+        size_t min_number_of_words = a->number_of_words > b->number_of_words ? b->number_of_words : a->number_of_words;
+        size_t tail_number_of_words = longer->number_of_words - min_number_of_words;
+
+        size_t similarity = kernels->exclusive_nor_pop_count (a->words, b->words, min_number_of_words);
+
+        if (tail_number_of_words == 0)
+                return similarity;
+
+        kernels = itty_bit_string_kernels_get ();
+        similarity += tail_number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        similarity -= kernels->pop_count (longer->words + min_number_of_words, tail_number_of_words);
+
+        return similarity;
 }
 
 size_t
-itty_bit_string_get_length (itty_bit_string_t *bit_string)
+itty_bit_string_evaluate_distance (itty_bit_string_t *a,
+                                   itty_bit_string_t *b)
 {
-        if (!bit_string->bit_length_computed) {
-                bit_string->bit_length = 0;
-                for (size_t i = 0; i < bit_string->number_of_words; i++) {
-                        if (bit_string->words[i] == 0)
-                                continue;
-
-                        size_t leading_zeros = __builtin_clzll (bit_string->words[i]);
-                        size_t word_bit_length = ITTY_BIT_STRING_WORD_SIZE_IN_BITS - leading_zeros;
-                        bit_string->bit_length = ((bit_string->number_of_words - i - 1) * ITTY_BIT_STRING_WORD_SIZE_IN_BITS) + word_bit_length;
-                        break;
-                }
-                bit_string->bit_length_computed = true;
-        }
-        return bit_string->bit_length;
+        if (a->sparse != NULL || b->sparse != NULL)
+                return itty_bit_string_evaluate_sparse_distance (a, b);
+
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_get_kernels_for_operands (a, b);
+        itty_bit_string_t *longer = a->number_of_words > b->number_of_words ? a : b;
+        size_t min_number_of_words = a->number_of_words > b->number_of_words ? b->number_of_words : a->number_of_words;
+        size_t tail_number_of_words = longer->number_of_words - min_number_of_words;
+
+        size_t distance = kernels->exclusive_or_pop_count (a->words, b->words, min_number_of_words);
+
+        if (tail_number_of_words == 0)
+                return distance;
+
+        kernels = itty_bit_string_kernels_get ();
+        distance += kernels->pop_count (longer->words + min_number_of_words, tail_number_of_words);
+
+        return distance;
 }
 
 size_t
-itty_bit_string_evaluate_similarity (itty_bit_string_t *a,
-                                     itty_bit_string_t *b)
+itty_bit_string_evaluate_overlap (itty_bit_string_t *a,
+                                  itty_bit_string_t *b)
 {
-        itty_bit_string_t *exclusive_nor_result = itty_bit_string_exclusive_nor (a, b);
-        size_t similarity = itty_bit_string_get_pop_count (exclusive_nor_result);
-        itty_bit_string_free (exclusive_nor_result);
-        return similarity;
+        if (a->sparse != NULL || b->sparse != NULL)
+                return itty_bit_string_evaluate_sparse_overlap (a, b);
+
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_get_kernels_for_operands (a, b);
+        size_t min_number_of_words = a->number_of_words > b->number_of_words ? b->number_of_words : a->number_of_words;
+
+        return kernels->mask_pop_count (a->words, b->words, min_number_of_words);
 }
 
 int
@@ -248,16 +984,53 @@ itty_bit_string_compare (itty_bit_string_t *a,
                 return -1;
         if (itty_bit_string_get_number_of_words (a) > itty_bit_string_get_number_of_words (b))
                 return 1;
-        return memcmp (a->words, b->words, a->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        if (a->number_of_words == 0)
+                return 0;
+        if (a->sparse == NULL && b->sparse == NULL)
+                return memcmp (a->words, b->words, a->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+
+        size_t a_bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+        size_t b_bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+        size_t a_container_index = 0;
+        size_t b_container_index = 0;
+
+        for (size_t key = 0; key < itty_bit_string_get_number_of_stretches (a); key++) {
+                const size_t *a_words = itty_bit_string_get_stretch_words (a, key, &a_container_index, a_bitmap);
+                const size_t *b_words = itty_bit_string_get_stretch_words (b, key, &b_container_index, b_bitmap);
+
+                if (a_words == b_words)
+                        continue;
+
+                int comparison = memcmp (a_words, b_words, itty_bit_string_get_stretch_number_of_words (a, key) * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                if (comparison != 0)
+                        return comparison;
+        }
+
+        return 0;
+}
+
+bool
+itty_bit_string_equal (itty_bit_string_t *a,
+                       itty_bit_string_t *b)
+{
+        if (a->number_of_words != b->number_of_words)
+                return false;
+        if (a->hash_computed && b->hash_computed && a->hash != b->hash)
+                return false;
+        return itty_bit_string_compare (a, b) == 0;
 }
 
 int
 itty_bit_string_compare_by_pop_count (itty_bit_string_t *a,
                                       itty_bit_string_t *b)
 {
-        return (int) (itty_bit_string_get_pop_count (a) - itty_bit_string_get_pop_count (b));
+        size_t a_pop_count = itty_bit_string_get_pop_count (a);
+        size_t b_pop_count = itty_bit_string_get_pop_count (b);
+
+        return (a_pop_count > b_pop_count) - (a_pop_count < b_pop_count);
 }
 
+/* NULL while sparse; itty_bit_string_copy_words reads either form */
 void *
 itty_bit_string_get_words (itty_bit_string_t *bit_string)
 {
@@ -297,7 +1070,7 @@ itty_bit_string_iterator_next (itty_bit_string_iterator_t *iterator,
                                size_t                     *word)
 {
         if (iterator->current_index < iterator->bit_string->number_of_words) {
-                *word = iterator->bit_string->words[iterator->current_index];
+                *word = itty_bit_string_get_word (iterator->bit_string, iterator->current_index);
                 iterator->current_index++;
                 return true;
         } else {
@@ -306,6 +1079,7 @@ itty_bit_string_iterator_next (itty_bit_string_iterator_t *iterator,
         }
 }
 
+/* Only a split that runs past the end is copied; the rest are views */
 itty_bit_string_list_t *
 itty_bit_string_split (itty_bit_string_t *bit_string,
                        size_t             number_of_bit_strings)
@@ -314,17 +1088,31 @@ itty_bit_string_split (itty_bit_string_t *bit_string,
                 return NULL;
         }
 
+        itty_bit_string_make_dense (bit_string);
+
         size_t total_bits = bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
         size_t bits_per_split = (total_bits + number_of_bit_strings - 1) / number_of_bit_strings;
         size_t words_per_split = (bits_per_split + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
 
         itty_bit_string_list_t *split_list = itty_bit_string_list_new ();
         for (size_t i = 0; i < number_of_bit_strings; i++) {
-                itty_bit_string_t *split = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
-                for (size_t j = 0; j < words_per_split; j++) {
-                        size_t word_index = i * words_per_split + j;
-                        size_t word = (word_index < bit_string->number_of_words) ? bit_string->words[word_index] : 0;
-                        itty_bit_string_append_word (split, word);
+                size_t word_offset = i * words_per_split;
+                itty_bit_string_t *split;
+
+                if (word_offset + words_per_split <= bit_string->number_of_words) {
+                        split = itty_bit_string_new_view (bit_string, word_offset, words_per_split);
+                } else {
+                        size_t number_of_words_left = 0;
+
+                        if (word_offset < bit_string->number_of_words)
+                                number_of_words_left = bit_string->number_of_words - word_offset;
+
+                        split = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                        itty_bit_string_reserve (split, words_per_split);
+                        if (number_of_words_left > 0)
+                                memcpy (split->words, bit_string->words + word_offset, number_of_words_left * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                        split->number_of_words = number_of_words_left;
+                        itty_bit_string_append_zeros (split, words_per_split - number_of_words_left);
                 }
                 itty_bit_string_list_append (split_list, split);
         }
@@ -338,14 +1126,10 @@ itty_bit_string_concatenate (itty_bit_string_t *a,
 {
         size_t total_words = a->number_of_words + b->number_of_words;
         itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
-        result->words = malloc (total_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
-        if (!result->words) {
-                free (result);
-                return NULL;
-        }
+        itty_bit_string_reserve (result, total_words);
 
-        memcpy (result->words, a->words, a->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
-        memcpy (result->words + a->number_of_words, b->words, b->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        itty_bit_string_copy_words (a, result->words, a->number_of_words);
+        itty_bit_string_copy_words (b, result->words + a->number_of_words, b->number_of_words);
 
         result->number_of_words = total_words;
 
@@ -365,111 +1149,561 @@ itty_bit_string_reduce_by_half (itty_bit_string_t *bit_string)
 
         size_t half_number_of_words = bit_string->number_of_words / 2;
 
-        itty_bit_string_t *first_half = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_ONLY);
-        first_half->words = bit_string->words;
-        first_half->number_of_words = half_number_of_words;
-
-        itty_bit_string_t *second_half = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_ONLY);
-        second_half->words = bit_string->words + half_number_of_words;
-        second_half->number_of_words = half_number_of_words;
+        itty_bit_string_t *first_half = itty_bit_string_new_view (bit_string, 0, half_number_of_words);
+        itty_bit_string_t *second_half = itty_bit_string_new_view (bit_string, half_number_of_words, half_number_of_words);
 
         itty_bit_string_t *reduced_bit_string = itty_bit_string_mask (first_half, second_half);
 
-        first_half->words = NULL;
-        second_half->words = NULL;
-
         itty_bit_string_free (first_half);
         itty_bit_string_free (second_half);
 
         return reduced_bit_string;
 }
 
-char *
-itty_bit_string_present (itty_bit_string_t                     *bit_string,
-                         itty_bit_string_presentation_format_t  format)
+/* Bit operations count from the top of words[0], the order strings are presented in */
+static size_t
+itty_bit_string_get_number_of_words_for_bits (size_t number_of_bits)
 {
-        size_t total_bits = bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
-        size_t buffer_size = 0;
+        return (number_of_bits + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+}
 
-        switch (format) {
-                case ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY:
-                case ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY:
-                        buffer_size = total_bits;
+/* result may alias words */
+static void
+itty_bit_string_shift_words_left (size_t       *result,
+                                  const size_t *words,
+                                  size_t        number_of_words,
+                                  size_t        count)
+{
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+        size_t word_shift = count / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        unsigned int bit_shift = count % ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
 
-                        if (format == ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY)
-                                buffer_size += strlen ("0b");
-                        break;
-                case ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL:
-                case ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY:
-                        buffer_size = bit_string->number_of_words * (ITTY_BIT_STRING_WORD_SIZE_IN_BYTES * 2 + 1);
+        if (word_shift >= number_of_words) {
+                memset (result, 0, number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                return;
+        }
 
-                        if (format == ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY)
-                                buffer_size += strlen ("0x");
-                        break;
-                default:
-                        return NULL;
+        size_t number_of_words_kept = number_of_words - word_shift;
+
+        if (bit_shift == 0) {
+                memmove (result, words + word_shift, number_of_words_kept * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        } else {
+                kernels->funnel_shift (result, words + word_shift, words + word_shift + 1, number_of_words_kept - 1, bit_shift);
+                result[number_of_words_kept - 1] = words[number_of_words - 1] << bit_shift;
         }
-        buffer_size++;
 
-        char *bit_string_representation = malloc (buffer_size);
+        memset (result + number_of_words_kept, 0, word_shift * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+}
+
+/* result must not alias words */
+static void
+itty_bit_string_shift_words_right (size_t       *result,
+                                   const size_t *words,
+                                   size_t        number_of_words,
+                                   size_t        count)
+{
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+        size_t word_shift = count / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        unsigned int bit_shift = count % ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+        if (word_shift >= number_of_words) {
+                memset (result, 0, number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                return;
+        }
+
+        size_t number_of_words_kept = number_of_words - word_shift;
+
+        if (bit_shift == 0) {
+                memcpy (result + word_shift, words, number_of_words_kept * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        } else {
+                result[word_shift] = words[0] >> bit_shift;
+                kernels->funnel_shift (result + word_shift + 1, words, words + 1, number_of_words_kept - 1, ITTY_BIT_STRING_WORD_SIZE_IN_BITS - bit_shift);
+        }
+
+        memset (result, 0, word_shift * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+}
+
+/* result must not alias words */
+static void
+itty_bit_string_rotate_words_left (size_t       *result,
+                                   const size_t *words,
+                                   size_t        number_of_words,
+                                   size_t        count)
+{
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+        size_t word_shift = count / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        unsigned int bit_shift = count % ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t number_of_words_wrapped = number_of_words - word_shift;
+
+        if (bit_shift == 0) {
+                memcpy (result, words + word_shift, number_of_words_wrapped * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                memcpy (result + number_of_words_wrapped, words, word_shift * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+                return;
+        }
+
+        kernels->funnel_shift (result, words + word_shift, words + word_shift + 1, number_of_words_wrapped - 1, bit_shift);
+        result[number_of_words_wrapped - 1] = (words[number_of_words - 1] << bit_shift) |
+                                              (words[0] >> (ITTY_BIT_STRING_WORD_SIZE_IN_BITS - bit_shift));
+        kernels->funnel_shift (result + number_of_words_wrapped, words, words + 1, word_shift, bit_shift);
+}
+
+/* Right aligns bit_count bits from bit_offset below the top; result must not alias words */
+static void
+itty_bit_string_extract_words (size_t       *result,
+                               const size_t *words,
+                               size_t        number_of_words,
+                               size_t        bit_offset,
+                               size_t        bit_count)
+{
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+        size_t number_of_result_words = itty_bit_string_get_number_of_words_for_bits (bit_count);
+        size_t count = number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS - bit_offset - bit_count;
+        size_t word_shift = count / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        unsigned int bit_shift = count % ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t first_word = number_of_words - word_shift - number_of_result_words;
+        size_t number_of_padding_bits = number_of_result_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS - bit_count;
+
+        if (number_of_result_words == 0)
+                return;
+
+        if (bit_shift == 0) {
+                memcpy (result, words + first_word, number_of_result_words * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        } else if (first_word > 0) {
+                kernels->funnel_shift (result, words + first_word - 1, words + first_word, number_of_result_words, ITTY_BIT_STRING_WORD_SIZE_IN_BITS - bit_shift);
+        } else {
+                result[0] = words[0] >> bit_shift;
+                kernels->funnel_shift (result + 1, words, words + 1, number_of_result_words - 1, ITTY_BIT_STRING_WORD_SIZE_IN_BITS - bit_shift);
+        }
+
+        if (number_of_padding_bits > 0)
+                result[0] &= SIZE_MAX >> number_of_padding_bits;
+}
+
+typedef void (* itty_bit_string_shift_function_t) (size_t       *result,
+                                                   const size_t *words,
+                                                   size_t        number_of_words,
+                                                   size_t        count);
+
+static void
+itty_bit_string_apply_shift (itty_bit_string_t                *result,
+                             itty_bit_string_t                *bit_string,
+                             size_t                            count,
+                             itty_bit_string_shift_function_t  shift_function)
+{
+        size_t number_of_words = bit_string->number_of_words;
+        itty_bit_string_t *source = bit_string;
+
+        if (result == bit_string || bit_string->sparse != NULL)
+                source = itty_bit_string_copy (bit_string);
+
+        itty_bit_string_prepare_destination (result, number_of_words);
+
+        if (number_of_words > 0)
+                shift_function (result->words, source->words, number_of_words, count);
+
+        if (source != bit_string)
+                itty_bit_string_free (source);
+}
+
+void
+itty_bit_string_shift_left_into (itty_bit_string_t *result,
+                                 itty_bit_string_t *bit_string,
+                                 size_t             count)
+{
+        itty_bit_string_apply_shift (result, bit_string, count, itty_bit_string_shift_words_left);
+}
+
+void
+itty_bit_string_shift_right_into (itty_bit_string_t *result,
+                                  itty_bit_string_t *bit_string,
+                                  size_t             count)
+{
+        itty_bit_string_apply_shift (result, bit_string, count, itty_bit_string_shift_words_right);
+}
+
+void
+itty_bit_string_rotate_left_into (itty_bit_string_t *result,
+                                  itty_bit_string_t *bit_string,
+                                  size_t             count)
+{
+        size_t number_of_bits = bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+        if (number_of_bits > 0)
+                count %= number_of_bits;
+
+        itty_bit_string_apply_shift (result, bit_string, count, itty_bit_string_rotate_words_left);
+}
+
+void
+itty_bit_string_rotate_right_into (itty_bit_string_t *result,
+                                   itty_bit_string_t *bit_string,
+                                   size_t             count)
+{
+        size_t number_of_bits = bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+        if (number_of_bits > 0)
+                count = (number_of_bits - count % number_of_bits) % number_of_bits;
+
+        itty_bit_string_apply_shift (result, bit_string, count, itty_bit_string_rotate_words_left);
+}
+
+itty_bit_string_t *
+itty_bit_string_shift_left (itty_bit_string_t *bit_string,
+                            size_t             count)
+{
+        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_shift_left_into (result, bit_string, count);
+        return result;
+}
+
+itty_bit_string_t *
+itty_bit_string_shift_right (itty_bit_string_t *bit_string,
+                             size_t             count)
+{
+        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_shift_right_into (result, bit_string, count);
+        return result;
+}
+
+itty_bit_string_t *
+itty_bit_string_rotate_left (itty_bit_string_t *bit_string,
+                             size_t             count)
+{
+        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_rotate_left_into (result, bit_string, count);
+        return result;
+}
+
+itty_bit_string_t *
+itty_bit_string_rotate_right (itty_bit_string_t *bit_string,
+                              size_t             count)
+{
+        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_rotate_right_into (result, bit_string, count);
+        return result;
+}
+
+itty_bit_string_t *
+itty_bit_string_extract (itty_bit_string_t *bit_string,
+                         size_t             bit_offset,
+                         size_t             bit_count)
+{
+        size_t number_of_words = itty_bit_string_get_number_of_words_for_bits (bit_count);
+
+        assert (bit_offset <= bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+        assert (bit_count <= bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS - bit_offset);
+
+        itty_bit_string_t *source = itty_bit_string_borrow_dense (bit_string);
+        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_prepare_destination (result, number_of_words);
+        itty_bit_string_extract_words (result->words, source->words, source->number_of_words, bit_offset, bit_count);
+        itty_bit_string_release_dense (bit_string, source);
+
+        return result;
+}
+
+itty_bit_string_t *
+itty_bit_string_concatenate_bits (itty_bit_string_t *a,
+                                  size_t             a_bit_count,
+                                  itty_bit_string_t *b,
+                                  size_t             b_bit_count)
+{
+        size_t a_number_of_bits = a->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t b_number_of_bits = b->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+        size_t number_of_words = itty_bit_string_get_number_of_words_for_bits (a_bit_count + b_bit_count);
+        size_t a_number_of_words = itty_bit_string_get_number_of_words_for_bits (a_bit_count);
+        size_t b_number_of_words = itty_bit_string_get_number_of_words_for_bits (b_bit_count);
+
+        assert (a_bit_count <= a_number_of_bits);
+        assert (b_bit_count <= b_number_of_bits);
+
+        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_prepare_destination (result, number_of_words);
+
+        if (number_of_words == 0)
+                return result;
+
+        itty_bit_string_t *dense_a = itty_bit_string_borrow_dense (a);
+        itty_bit_string_t *dense_b = itty_bit_string_borrow_dense (b);
+
+        memset (result->words, 0, (number_of_words - a_number_of_words) * ITTY_BIT_STRING_WORD_SIZE_IN_BYTES);
+        itty_bit_string_extract_words (result->words + number_of_words - a_number_of_words,
+                                       dense_a->words, dense_a->number_of_words,
+                                       a_number_of_bits - a_bit_count, a_bit_count);
+        itty_bit_string_shift_words_left (result->words, result->words, number_of_words, b_bit_count);
+
+        if (b_number_of_words > 0) {
+                size_t *b_words = result->words + number_of_words - b_number_of_words;
+                size_t shared_word = b_words[0];
+
+                itty_bit_string_extract_words (b_words,
+                                               dense_b->words, dense_b->number_of_words,
+                                               b_number_of_bits - b_bit_count, b_bit_count);
+                b_words[0] |= shared_word;
+        }
+
+        itty_bit_string_release_dense (a, dense_a);
+        itty_bit_string_release_dense (b, dense_b);
+
+        return result;
+}
+
+/* Hexadecimal display still spaces out words that are all leading zeros */
+static const char itty_bit_string_binary_digits[16][4] = {
+        "0000", "0001", "0010", "0011", "0100", "0101", "0110", "0111",
+        "1000", "1001", "1010", "1011", "1100", "1101", "1110", "1111"
+};
+
+static const char itty_bit_string_hexadecimal_digits[16] = "0123456789abcdef";
+
+#define ITTY_BIT_STRING_NUMBER_OF_HEXADECIMAL_DIGITS (ITTY_BIT_STRING_WORD_SIZE_IN_BYTES * 2)
+
+typedef struct {
+        char   *buffer;
+        size_t  buffer_size;
+        FILE   *file;
+        size_t  length;
+        size_t  chunk_used;
+        bool    failed;
+        char    chunk[4096];
+} itty_bit_string_presenter_t;
+
+static void
+itty_bit_string_presenter_flush (itty_bit_string_presenter_t *presenter)
+{
+        if (presenter->chunk_used == 0)
+                return;
+
+        if (fwrite (presenter->chunk, 1, presenter->chunk_used, presenter->file) != presenter->chunk_used)
+                presenter->failed = true;
+
+        presenter->chunk_used = 0;
+}
+
+static inline void
+itty_bit_string_presenter_write (itty_bit_string_presenter_t *presenter,
+                                 const char                  *text,
+                                 size_t                       length)
+{
+        if (presenter->file != NULL) {
+                if (presenter->chunk_used + length > sizeof (presenter->chunk))
+                        itty_bit_string_presenter_flush (presenter);
+
+                memcpy (presenter->chunk + presenter->chunk_used, text, length);
+                presenter->chunk_used += length;
+        } else if (presenter->length + 1 < presenter->buffer_size) {
+                size_t space_left = presenter->buffer_size - presenter->length - 1;
+
+                memcpy (presenter->buffer + presenter->length, text, length < space_left ? length : space_left);
+        }
+
+        presenter->length += length;
+}
+
+static void
+itty_bit_string_format_binary_word (size_t  word,
+                                    char   *digits)
+{
+        for (size_t i = 0; i < ITTY_BIT_STRING_WORD_SIZE_IN_BITS / 4; i++) {
+                size_t nibble = (word >> (ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 4 * (i + 1))) & 0xf;
+                memcpy (digits + 4 * i, itty_bit_string_binary_digits[nibble], 4);
+        }
+}
+
+static void
+itty_bit_string_format_hexadecimal_word (size_t  word,
+                                         char   *digits)
+{
+        for (size_t i = 0; i < ITTY_BIT_STRING_NUMBER_OF_HEXADECIMAL_DIGITS; i++) {
+                size_t nibble = (word >> (ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 4 * (i + 1))) & 0xf;
+                digits[i] = itty_bit_string_hexadecimal_digits[nibble];
+        }
+}
+
+static void
+itty_bit_string_write_presentation_words (itty_bit_string_t                     *bit_string,
+                                          itty_bit_string_presentation_format_t  format,
+                                          itty_bit_string_presenter_t           *presenter,
+                                          const size_t                          *words,
+                                          size_t                                 word_offset,
+                                          size_t                                 number_of_words,
+                                          size_t                                 first_nonzero_word)
+{
+        char digits[ITTY_BIT_STRING_WORD_SIZE_IN_BITS];
 
-        size_t output_index = 0;
-        bool at_leading_zero = true;
         switch (format) {
         case ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY:
-                for (size_t i = 0; i < bit_string->number_of_words; i++) {
-                        size_t word = bit_string->words[i];
-                        for (size_t j = ITTY_BIT_STRING_WORD_SIZE_IN_BITS; j > 0; j--) {
-                                bit_string_representation[output_index++] = (word & (1UL << (j - 1))) ? '1' : '0';
-                        }
+                for (size_t i = 0; i < number_of_words; i++) {
+                        itty_bit_string_format_binary_word (words[i], digits);
+                        itty_bit_string_presenter_write (presenter, digits, ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
                 }
-                bit_string_representation[output_index] = '\0';
                 break;
 
         case ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL:
-                bit_string_representation[output_index] = '\0';
-                for (size_t i = 0; i < bit_string->number_of_words; i++) {
-                        output_index += snprintf (&bit_string_representation[output_index], buffer_size - output_index, "%016lx", bit_string->words[i]);
+                for (size_t i = 0; i < number_of_words; i++) {
+                        itty_bit_string_format_hexadecimal_word (words[i], digits);
+                        itty_bit_string_presenter_write (presenter, digits, ITTY_BIT_STRING_NUMBER_OF_HEXADECIMAL_DIGITS);
                 }
                 break;
 
         case ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY:
-                strcpy (bit_string_representation, "0b");
-                output_index = 2;
-
-                for (size_t i = 0; i < bit_string->number_of_words; i++) {
-                        size_t word = bit_string->words[i];
-                        for (size_t j = ITTY_BIT_STRING_WORD_SIZE_IN_BITS; j > 0; j--) {
-                                char bit = (word & (1UL << (j - 1))) ? '1' : '0';
-                                if (bit == '1' || !at_leading_zero) {
-                                        bit_string_representation[output_index++] = bit;
-                                        at_leading_zero = false;
-                                }
-                        }
+                for (size_t i = first_nonzero_word > word_offset ? first_nonzero_word - word_offset : 0; i < number_of_words; i++) {
+                        size_t leading_zeros = word_offset + i == first_nonzero_word ? __builtin_clzl (words[i]) : 0;
+
+                        itty_bit_string_format_binary_word (words[i], digits);
+                        itty_bit_string_presenter_write (presenter, digits + leading_zeros, ITTY_BIT_STRING_WORD_SIZE_IN_BITS - leading_zeros);
                 }
-                bit_string_representation[output_index] = '\0';
                 break;
 
         case ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY:
-                strcpy (bit_string_representation, "0x");
-                output_index = 2;
-
-                for (size_t i = 0; i < bit_string->number_of_words; i++) {
-                        char word_buffer[ITTY_BIT_STRING_WORD_SIZE_IN_BYTES * 2 + 1];
-                        snprintf (word_buffer, sizeof (word_buffer), "%016lx", bit_string->words[i]);
-                        for (size_t j = 0; j < strlen (word_buffer); j++) {
-                                char hex_digit = word_buffer[j];
-                                if (hex_digit != '0' || !at_leading_zero) {
-                                        bit_string_representation[output_index++] = hex_digit;
-                                        at_leading_zero = false;
-                                }
+                for (size_t i = 0; i < number_of_words; i++) {
+                        if (word_offset + i >= first_nonzero_word) {
+                                size_t leading_zeros = word_offset + i == first_nonzero_word ? __builtin_clzl (words[i]) / 4 : 0;
+
+                                itty_bit_string_format_hexadecimal_word (words[i], digits);
+                                itty_bit_string_presenter_write (presenter, digits + leading_zeros, ITTY_BIT_STRING_NUMBER_OF_HEXADECIMAL_DIGITS - leading_zeros);
                         }
-                        if (i < bit_string->number_of_words - 1)
-                                bit_string_representation[output_index++] = ' ';
+
+                        if (word_offset + i < bit_string->number_of_words - 1)
+                                itty_bit_string_presenter_write (presenter, " ", 1);
                 }
-                bit_string_representation[output_index] = '\0';
                 break;
+
+        default:
+                break;
+        }
+}
+
+static bool
+itty_bit_string_write_presentation (itty_bit_string_t                     *bit_string,
+                                    itty_bit_string_presentation_format_t  format,
+                                    itty_bit_string_presenter_t           *presenter)
+{
+        size_t bitmap[ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER];
+        size_t container_index = 0;
+        size_t first_nonzero_word = 0;
+        size_t leading_zeros;
+
+        switch (format) {
+        case ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY:
+        case ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL:
+                break;
+
+        case ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY:
+                itty_bit_string_presenter_write (presenter, "0b", strlen ("0b"));
+                first_nonzero_word = itty_bit_string_find_leading_zeros (bit_string, &leading_zeros);
+                break;
+
+        case ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY:
+                itty_bit_string_presenter_write (presenter, "0x", strlen ("0x"));
+                first_nonzero_word = itty_bit_string_find_leading_zeros (bit_string, &leading_zeros);
+                break;
+
+        default:
+                return false;
+        }
+
+        for (size_t key = 0; key < itty_bit_string_get_number_of_stretches (bit_string); key++)
+                itty_bit_string_write_presentation_words (bit_string, format, presenter,
+                                                          itty_bit_string_get_stretch_words (bit_string, key, &container_index, bitmap),
+                                                          key * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER,
+                                                          itty_bit_string_get_stretch_number_of_words (bit_string, key),
+                                                          first_nonzero_word);
+
+        return true;
+}
+
+size_t
+itty_bit_string_get_presentation_length (itty_bit_string_t                     *bit_string,
+                                         itty_bit_string_presentation_format_t  format)
+{
+        size_t first_nonzero_word;
+        size_t leading_zeros;
+        size_t length;
+
+        switch (format) {
+        case ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY:
+                return bit_string->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+        case ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL:
+                return bit_string->number_of_words * ITTY_BIT_STRING_NUMBER_OF_HEXADECIMAL_DIGITS;
+
+        case ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY:
+                length = strlen ("0b");
+
+                first_nonzero_word = itty_bit_string_find_leading_zeros (bit_string, &leading_zeros);
+                if (first_nonzero_word < bit_string->number_of_words) {
+                        length += (bit_string->number_of_words - first_nonzero_word) * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                        length -= leading_zeros;
+                }
+                return length;
+
+        case ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY:
+                length = strlen ("0x");
+                if (bit_string->number_of_words == 0)
+                        return length;
+
+                length += bit_string->number_of_words - 1;
+
+                first_nonzero_word = itty_bit_string_find_leading_zeros (bit_string, &leading_zeros);
+                if (first_nonzero_word < bit_string->number_of_words) {
+                        length += (bit_string->number_of_words - first_nonzero_word) * ITTY_BIT_STRING_NUMBER_OF_HEXADECIMAL_DIGITS;
+                        length -= leading_zeros / 4;
+                }
+                return length;
+
+        default:
+                return 0;
         }
+}
+
+size_t
+itty_bit_string_present_to_buffer (itty_bit_string_t                     *bit_string,
+                                   itty_bit_string_presentation_format_t  format,
+                                   char                                  *buffer,
+                                   size_t                                 buffer_size)
+{
+        itty_bit_string_presenter_t presenter = {
+                .buffer = buffer,
+                .buffer_size = buffer_size,
+        };
+
+        itty_bit_string_write_presentation (bit_string, format, &presenter);
+
+        if (buffer_size > 0)
+                buffer[presenter.length < buffer_size ? presenter.length : buffer_size - 1] = '\0';
+
+        return presenter.length;
+}
+
+bool
+itty_bit_string_present_to_file (itty_bit_string_t                     *bit_string,
+                                 itty_bit_string_presentation_format_t  format,
+                                 FILE                                  *file)
+{
+        itty_bit_string_presenter_t presenter = {
+                .file = file,
+        };
+
+        if (!itty_bit_string_write_presentation (bit_string, format, &presenter))
+                return false;
+
+        itty_bit_string_presenter_flush (&presenter);
+
+        return !presenter.failed;
+}
+
+char *
+itty_bit_string_present (itty_bit_string_t                     *bit_string,
+                         itty_bit_string_presentation_format_t  format)
+{
+        if (format > ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY)
+                return NULL;
+
+        size_t buffer_size = itty_bit_string_get_presentation_length (bit_string, format) + 1;
+        char *bit_string_representation = malloc (buffer_size);
+
+        itty_bit_string_present_to_buffer (bit_string, format, bit_string_representation, buffer_size);
 
         return bit_string_representation;
 }
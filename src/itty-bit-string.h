@@ -3,6 +3,8 @@
 #include <limits.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 
 #define ITTY_BIT_STRING_WORD_SIZE_IN_BYTES (sizeof (size_t))
 #define ITTY_BIT_STRING_WORD_SIZE_IN_BITS (sizeof (size_t) * CHAR_BIT)
@@ -38,9 +40,24 @@ struct itty_bit_string_iterator_t {
 };
 
 itty_bit_string_t *itty_bit_string_new (itty_bit_string_mutability_t mutability);
+itty_bit_string_t *itty_bit_string_new_aligned (itty_bit_string_mutability_t mutability);
+bool itty_bit_string_is_aligned (itty_bit_string_t *bit_string);
+bool itty_bit_string_is_sparse (itty_bit_string_t *bit_string);
+
+itty_bit_string_t *itty_bit_string_ref (itty_bit_string_t *bit_string);
+void itty_bit_string_unref (itty_bit_string_t *bit_string);
 
 void itty_bit_string_free (itty_bit_string_t *bit_string);
 
+itty_bit_string_t *itty_bit_string_copy (itty_bit_string_t *bit_string);
+
+itty_bit_string_t *itty_bit_string_new_view (itty_bit_string_t *bit_string,
+                                             size_t             word_offset,
+                                             size_t             number_of_words);
+
+void itty_bit_string_reserve (itty_bit_string_t *bit_string,
+                              size_t             number_of_words);
+
 void itty_bit_string_append_word (itty_bit_string_t *bit_string,
                                   size_t             word);
 
@@ -57,14 +74,34 @@ itty_bit_string_t *itty_bit_string_combine (itty_bit_string_t *a,
 itty_bit_string_t *itty_bit_string_mask (itty_bit_string_t *a,
                                          itty_bit_string_t *b);
 
+void itty_bit_string_exclusive_nor_into (itty_bit_string_t *result,
+                                         itty_bit_string_t *a,
+                                         itty_bit_string_t *b);
+void itty_bit_string_exclusive_or_into (itty_bit_string_t *result,
+                                        itty_bit_string_t *a,
+                                        itty_bit_string_t *b);
+void itty_bit_string_combine_into (itty_bit_string_t *result,
+                                   itty_bit_string_t *a,
+                                   itty_bit_string_t *b);
+void itty_bit_string_mask_into (itty_bit_string_t *result,
+                                itty_bit_string_t *a,
+                                itty_bit_string_t *b);
+
 size_t itty_bit_string_get_pop_count (itty_bit_string_t *bit_string);
 size_t itty_bit_string_get_length (itty_bit_string_t *bit_string);
+uint64_t itty_bit_string_get_hash (itty_bit_string_t *bit_string);
 
 size_t itty_bit_string_evaluate_similarity (itty_bit_string_t *a,
                                             itty_bit_string_t *b);
+size_t itty_bit_string_evaluate_distance (itty_bit_string_t *a,
+                                          itty_bit_string_t *b);
+size_t itty_bit_string_evaluate_overlap (itty_bit_string_t *a,
+                                         itty_bit_string_t *b);
 
 int itty_bit_string_compare (itty_bit_string_t *a,
                              itty_bit_string_t *b);
+bool itty_bit_string_equal (itty_bit_string_t *a,
+                            itty_bit_string_t *b);
 
 int itty_bit_string_compare_by_pop_count (itty_bit_string_t *a,
                                           itty_bit_string_t *b);
@@ -79,8 +116,47 @@ itty_bit_string_t *itty_bit_string_concatenate (itty_bit_string_t *a,
                                                 itty_bit_string_t *b);
 itty_bit_string_t *itty_bit_string_double (itty_bit_string_t *bit_string);
 itty_bit_string_t *itty_bit_string_reduce_by_half (itty_bit_string_t *bit_string);
+
+void itty_bit_string_shift_left_into (itty_bit_string_t *result,
+                                      itty_bit_string_t *bit_string,
+                                      size_t             count);
+void itty_bit_string_shift_right_into (itty_bit_string_t *result,
+                                       itty_bit_string_t *bit_string,
+                                       size_t             count);
+void itty_bit_string_rotate_left_into (itty_bit_string_t *result,
+                                       itty_bit_string_t *bit_string,
+                                       size_t             count);
+void itty_bit_string_rotate_right_into (itty_bit_string_t *result,
+                                        itty_bit_string_t *bit_string,
+                                        size_t             count);
+
+itty_bit_string_t *itty_bit_string_shift_left (itty_bit_string_t *bit_string,
+                                               size_t             count);
+itty_bit_string_t *itty_bit_string_shift_right (itty_bit_string_t *bit_string,
+                                                size_t             count);
+itty_bit_string_t *itty_bit_string_rotate_left (itty_bit_string_t *bit_string,
+                                                size_t             count);
+itty_bit_string_t *itty_bit_string_rotate_right (itty_bit_string_t *bit_string,
+                                                 size_t             count);
+
+itty_bit_string_t *itty_bit_string_extract (itty_bit_string_t *bit_string,
+                                            size_t             bit_offset,
+                                            size_t             bit_count);
+itty_bit_string_t *itty_bit_string_concatenate_bits (itty_bit_string_t *a,
+                                                     size_t             a_bit_count,
+                                                     itty_bit_string_t *b,
+                                                     size_t             b_bit_count);
 char *itty_bit_string_present (itty_bit_string_t                     *bit_string,
                                itty_bit_string_presentation_format_t  format);
+size_t itty_bit_string_get_presentation_length (itty_bit_string_t                     *bit_string,
+                                                itty_bit_string_presentation_format_t  format);
+size_t itty_bit_string_present_to_buffer (itty_bit_string_t                     *bit_string,
+                                          itty_bit_string_presentation_format_t  format,
+                                          char                                  *buffer,
+                                          size_t                                 buffer_size);
+bool itty_bit_string_present_to_file (itty_bit_string_t                     *bit_string,
+                                      itty_bit_string_presentation_format_t  format,
+                                      FILE                                  *file);
 void itty_bit_string_iterator_init (itty_bit_string_t          *bit_string,
                                     itty_bit_string_iterator_t *iterator);
 void itty_bit_string_iterator_init_at_word_offset (itty_bit_string_t          *bit_string,
@@ -125,3 +125,83 @@ itty_manager_free_condition (itty_manager_t   *manager,
         pthread_mutex_unlock (&manager->mutex);
 }
 
+typedef struct {
+        itty_work_t           work;
+        itty_range_handler_t  handler;
+        void                 *data;
+        size_t                start;
+        size_t                end;
+        itty_condition_t     *condition;
+        size_t               *number_of_tasks_left;
+} itty_manager_range_task_t;
+
+static bool
+itty_manager_check_range_tasks_finished (void *data)
+{
+        size_t *number_of_tasks_left = data;
+
+        return *number_of_tasks_left == 0;
+}
+
+static void *
+itty_manager_run_range_task (void *data)
+{
+        itty_manager_range_task_t *task = data;
+        itty_condition_t *condition = task->condition;
+        size_t *number_of_tasks_left = task->number_of_tasks_left;
+
+        task->handler (task->data, task->start, task->end);
+
+        pthread_mutex_lock (&condition->mutex);
+        (*number_of_tasks_left)--;
+        if (*number_of_tasks_left == 0)
+                pthread_cond_broadcast (&condition->variable);
+        pthread_mutex_unlock (&condition->mutex);
+
+        return NULL;
+}
+
+/* Must not be called from a manager work handler */
+void
+itty_manager_run_in_parallel (itty_manager_t       *manager,
+                              size_t                number_of_items,
+                              size_t                minimum_items_per_task,
+                              itty_range_handler_t  handler,
+                              void                 *data)
+{
+        size_t number_of_tasks = number_of_items / (minimum_items_per_task > 0 ? minimum_items_per_task : 1);
+
+        if (number_of_tasks > (size_t) manager->number_of_queues)
+                number_of_tasks = manager->number_of_queues;
+
+        if (number_of_tasks <= 1) {
+                if (number_of_items > 0)
+                        handler (data, 0, number_of_items);
+                return;
+        }
+
+        size_t number_of_tasks_left = number_of_tasks;
+        itty_condition_t *condition = itty_manager_register_condition (manager, itty_manager_check_range_tasks_finished, &number_of_tasks_left);
+        itty_manager_range_task_t *tasks = calloc (number_of_tasks, sizeof (itty_manager_range_task_t));
+
+        for (size_t i = 0; i < number_of_tasks; i++) {
+                tasks[i].work.callback = itty_manager_run_range_task;
+                tasks[i].work.user_data = &tasks[i];
+                tasks[i].handler = handler;
+                tasks[i].data = data;
+                tasks[i].start = number_of_items * i / number_of_tasks;
+                tasks[i].end = number_of_items * (i + 1) / number_of_tasks;
+                tasks[i].condition = condition;
+                tasks[i].number_of_tasks_left = &number_of_tasks_left;
+        }
+
+        for (size_t i = 1; i < number_of_tasks; i++) {
+                itty_manager_enqueue_work (manager, &tasks[i].work);
+        }
+
+        itty_manager_run_range_task (&tasks[0]);
+        itty_manager_wait_for_condition (manager, condition);
+
+        itty_manager_free_condition (manager, condition);
+        free (tasks);
+}
@@ -3,11 +3,15 @@
 #include "itty-work-queue.h"
 #include <pthread.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef struct itty_manager_t itty_manager_t;
 typedef struct itty_condition_t itty_condition_t;
 
 typedef bool (*itty_condition_check_handler_t) (void *data);
+typedef void (*itty_range_handler_t) (void   *data,
+                                      size_t  start,
+                                      size_t  end);
 
 itty_manager_t *itty_manager_new (void);
 void itty_manager_free (itty_manager_t *manager);
@@ -24,3 +28,9 @@ void itty_manager_signal_condition (itty_manager_t   *manager,
                                     itty_condition_t *condition);
 void itty_manager_free_condition (itty_manager_t   *manager,
                                   itty_condition_t *condition);
+
+void itty_manager_run_in_parallel (itty_manager_t       *manager,
+                                   size_t                number_of_items,
+                                   size_t                minimum_items_per_task,
+                                   itty_range_handler_t  handler,
+                                   void                 *data);
@@ -1,4 +1,5 @@
 #include "itty-network.h"
+#include "itty-arena.h"
 #include "itty-bit-string.h"
 
 #include <stdio.h>
@@ -6,16 +7,21 @@
 
 struct itty_network_node_t {
         itty_bit_string_list_t *modulation_masks;
+        itty_bit_matrix_t *modulation_matrix;
 };
 
+/* Row 0 of attention_masks is the query mask and row 1 the value mask */
 struct itty_network_layer_t {
         itty_network_node_t **nodes;
         size_t number_of_nodes;
+        itty_bit_matrix_t *attention_masks;
+        size_t number_of_selected_positions;
 };
 
 struct itty_network_t {
         itty_network_layer_t **layers;
         size_t number_of_layers;
+        itty_arena_t *arena;
 };
 
 itty_network_node_t *
@@ -23,6 +29,16 @@ itty_network_node_new (itty_bit_string_list_t *modulation_masks)
 {
         itty_network_node_t *node = malloc (sizeof (itty_network_node_t));
         node->modulation_masks = modulation_masks;
+        node->modulation_matrix = NULL;
+        return node;
+}
+
+itty_network_node_t *
+itty_network_node_new_for_matrix (itty_bit_matrix_t *modulation_matrix)
+{
+        itty_network_node_t *node = malloc (sizeof (itty_network_node_t));
+        node->modulation_masks = NULL;
+        node->modulation_matrix = modulation_matrix;
         return node;
 }
 
@@ -31,6 +47,8 @@ itty_network_node_free (itty_network_node_t *node)
 {
         if (!node)
                 return;
+        itty_bit_string_list_free (node->modulation_masks);
+        itty_bit_matrix_free (node->modulation_matrix);
         free (node);
 }
 
@@ -40,10 +58,22 @@ itty_network_layer_new (void)
     itty_network_layer_t *layer = malloc (sizeof (itty_network_layer_t));
     layer->number_of_nodes = 0;
     layer->nodes = NULL;
+    layer->attention_masks = NULL;
+    layer->number_of_selected_positions = 0;
 
     return layer;
 }
 
+itty_network_layer_t *
+itty_network_layer_new_attention (itty_bit_matrix_t *attention_masks,
+                                  size_t             number_of_selected_positions)
+{
+        itty_network_layer_t *layer = itty_network_layer_new ();
+        layer->attention_masks = attention_masks;
+        layer->number_of_selected_positions = number_of_selected_positions;
+        return layer;
+}
+
 void
 itty_network_layer_append (itty_network_layer_t *layer,
                            itty_network_node_t  *node)
@@ -64,6 +94,7 @@ itty_network_layer_free (itty_network_layer_t *layer)
                 itty_network_node_free (layer->nodes[i]);
         }
         free (layer->nodes);
+        itty_bit_matrix_free (layer->attention_masks);
         free (layer);
 }
 
@@ -109,6 +140,52 @@ itty_network_layer_iterator_next (itty_network_layer_iterator_t  *iterator,
     }
 }
 
+static void
+itty_network_print_bit_string (const char        *label,
+                               itty_bit_string_t *bit_string)
+{
+        printf ("\t%s: ", label);
+        itty_bit_string_present_to_file (bit_string, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY, stdout);
+        printf ("\n");
+}
+
+static void
+itty_network_print_bit_string_list (const char             *label,
+                                    itty_bit_string_list_t *list)
+{
+        printf ("\t%s:\n", label);
+        itty_bit_string_list_present_to_file (list, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY, stdout);
+        printf ("\n");
+}
+
+static itty_bit_string_list_t *
+itty_network_attend (itty_network_layer_t   *layer,
+                     itty_bit_string_list_t *input)
+{
+        itty_bit_string_t *query_mask = itty_bit_matrix_get_row (layer->attention_masks, 0);
+        itty_bit_string_t *value_mask = itty_bit_matrix_get_row (layer->attention_masks, 1);
+        itty_bit_string_list_t *queries = itty_bit_string_list_new ();
+        itty_bit_string_list_t *values = itty_bit_string_list_new ();
+        itty_bit_string_list_iterator_t iterator;
+        itty_bit_string_t *bit_string;
+
+        itty_bit_string_list_iterator_init (input, &iterator);
+        while (itty_bit_string_list_iterator_next (&iterator, &bit_string)) {
+                itty_bit_string_list_append (queries, itty_bit_string_exclusive_or (bit_string, query_mask));
+                itty_bit_string_list_append (values, itty_bit_string_exclusive_or (bit_string, value_mask));
+        }
+
+        itty_bit_string_list_t *attended = itty_bit_string_list_attend (queries, input, values, layer->number_of_selected_positions);
+
+        itty_bit_string_list_free (queries);
+        itty_bit_string_list_free (values);
+        itty_bit_string_unref (query_mask);
+        itty_bit_string_unref (value_mask);
+
+        return attended;
+}
+
+/* Only the final outputs are copied out of the network's arena */
 itty_bit_string_list_t *
 itty_network_feed (itty_network_t         *network,
                    itty_bit_string_list_t *input)
@@ -118,25 +195,44 @@ itty_network_feed (itty_network_t         *network,
         itty_network_iterator_init (network, &net_iterator);
         itty_network_layer_t *layer;
 
+        itty_arena_reset (network->arena);
+        itty_arena_t *previous_arena = itty_arena_push_thread_default (network->arena);
+
         size_t layer_index = 0;
         while (itty_network_iterator_next (&net_iterator, &layer)) {
-                itty_bit_string_list_t *layer_outputs = itty_bit_string_list_new ();
+                itty_bit_string_list_t *layer_outputs;
                 itty_network_layer_iterator_t layer_iterator;
                 itty_network_layer_iterator_init (layer, &layer_iterator);
                 itty_network_node_t *node;
 
                 printf ("Layer %zu\n", layer_index);
+                if (layer->attention_masks != NULL) {
+                        itty_network_print_bit_string_list ("layer inputs", current_input);
+                        layer_outputs = itty_network_attend (layer, current_input);
+                        itty_network_print_bit_string_list ("attended outputs", layer_outputs);
+                } else {
+                        layer_outputs = itty_bit_string_list_new ();
+                }
+
                 while (itty_network_layer_iterator_next (&layer_iterator, &node)) {
-                        printf ("\tlayer inputs:\n%s\n", itty_bit_string_list_present (current_input, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY));
-                        itty_bit_string_list_t *modulated_inputs = itty_bit_string_list_exclusive_or (current_input, node->modulation_masks);
-                        printf ("\tmodulated inputs:\n%s\n", itty_bit_string_list_present (modulated_inputs, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY));
+                        itty_network_print_bit_string_list ("layer inputs", current_input);
+                        itty_bit_string_list_t *modulated_inputs;
+                        if (node->modulation_matrix != NULL) {
+                                itty_bit_matrix_t *modulated_matrix = itty_bit_matrix_exclusive_or_list (node->modulation_matrix, current_input);
+                                modulated_inputs = itty_bit_matrix_get_rows (modulated_matrix);
+                                itty_bit_matrix_free (modulated_matrix);
+                        } else {
+                                modulated_inputs = itty_bit_string_list_exclusive_or (current_input, node->modulation_masks);
+                        }
+                        itty_network_print_bit_string_list ("modulated inputs", modulated_inputs);
                         itty_bit_string_t *condensed_output = itty_bit_string_list_condense (modulated_inputs);
-                        printf ("\tcondensed output: %s\n", itty_bit_string_present (condensed_output, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY));
+                        itty_network_print_bit_string ("condensed output", condensed_output);
                         itty_bit_string_t *doubled_output = itty_bit_string_double (condensed_output);
-                        printf ("\tdoubled output: %s\n", itty_bit_string_present (doubled_output, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY));
+                        itty_network_print_bit_string ("doubled output", doubled_output);
                         itty_bit_string_free (condensed_output);
+                        itty_bit_string_list_free (modulated_inputs);
                         itty_bit_string_list_append (layer_outputs, doubled_output);
-                        printf ("\tlayout outputs:\n%s\n", itty_bit_string_list_present (layer_outputs, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY));
+                        itty_network_print_bit_string_list ("layout outputs", layer_outputs);
                 }
 
                 if (current_input != input)
@@ -146,7 +242,21 @@ itty_network_feed (itty_network_t         *network,
                 layer_index++;
         }
 
-        return current_input;
+        itty_arena_pop_thread_default (network->arena, previous_arena);
+
+        if (current_input == input)
+                return current_input;
+
+        itty_bit_string_list_t *output = itty_bit_string_list_new ();
+        itty_bit_string_list_iterator_t output_iterator;
+        itty_bit_string_list_iterator_init (current_input, &output_iterator);
+        itty_bit_string_t *bit_string;
+        while (itty_bit_string_list_iterator_next (&output_iterator, &bit_string)) {
+                itty_bit_string_list_append (output, itty_bit_string_copy (bit_string));
+        }
+        itty_bit_string_list_free (current_input);
+
+        return output;
 }
 
 itty_network_t *
@@ -155,6 +265,7 @@ itty_network_new (void)
         itty_network_t *network = malloc (sizeof (itty_network_t));
         network->number_of_layers = 0;
         network->layers = NULL;
+        network->arena = itty_arena_new ();
 
         return network;
 }
@@ -168,6 +279,8 @@ itty_network_free (itty_network_t *network)
         for (size_t i = 0; i < network->number_of_layers; i++) {
                 itty_network_layer_free (network->layers[i]);
         }
+        free (network->layers);
+        itty_arena_free (network->arena);
         free (network);
 }
 
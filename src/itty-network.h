@@ -1,5 +1,6 @@
 #pragma once
 
+#include "itty-bit-matrix.h"
 #include "itty-bit-string-list.h"
 
 typedef struct itty_network_t itty_network_t;
@@ -17,9 +18,12 @@ typedef struct {
 } itty_network_iterator_t;
 
 itty_network_node_t *itty_network_node_new (itty_bit_string_list_t *modulation_masks);
+itty_network_node_t *itty_network_node_new_for_matrix (itty_bit_matrix_t *modulation_matrix);
 void itty_network_node_free (itty_network_node_t *node);
 
 itty_network_layer_t *itty_network_layer_new (void);
+itty_network_layer_t *itty_network_layer_new_attention (itty_bit_matrix_t *attention_masks,
+                                                       size_t             number_of_selected_positions);
 
 void itty_network_layer_append (itty_network_layer_t *layer,
                                 itty_network_node_t  *node);
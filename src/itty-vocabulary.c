@@ -5,13 +5,47 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* text_lookup slots hold an index into texts plus one, zero marking an empty slot */
 struct itty_vocabulary_t {
         itty_bit_string_map_file_t *bit_string_map;
         char **texts;
         itty_bit_string_list_t *bit_strings;
         size_t count;
+        size_t *text_lookup;
+        size_t text_lookup_size;
 };
 
+static void
+itty_vocabulary_build_text_lookup (itty_vocabulary_t *vocabulary)
+{
+        size_t size = 16;
+
+        while (size < vocabulary->count * 2)
+                size *= 2;
+
+        vocabulary->text_lookup = calloc (size, sizeof (size_t));
+        vocabulary->text_lookup_size = size;
+
+        for (size_t i = 0; i < vocabulary->count; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_list_fetch (vocabulary->bit_strings, i);
+                size_t slot = itty_bit_string_get_hash (bit_string) & (size - 1);
+                bool is_duplicate = false;
+
+                while (vocabulary->text_lookup[slot] != 0) {
+                        itty_bit_string_t *other_bit_string = itty_bit_string_list_fetch (vocabulary->bit_strings, vocabulary->text_lookup[slot] - 1);
+
+                        if (itty_bit_string_equal (other_bit_string, bit_string)) {
+                                is_duplicate = true;
+                                break;
+                        }
+                        slot = (slot + 1) & (size - 1);
+                }
+
+                if (!is_duplicate)
+                        vocabulary->text_lookup[slot] = i + 1;
+        }
+}
+
 itty_vocabulary_t *
 itty_vocabulary_new (const char *text_file,
                      const char *bit_string_file)
@@ -54,6 +88,8 @@ itty_vocabulary_new (const char *text_file,
         free (line);
         fclose (fp);
 
+        itty_vocabulary_build_text_lookup (vocabulary);
+
         return vocabulary;
 }
 
@@ -67,6 +103,7 @@ itty_vocabulary_free (itty_vocabulary_t *vocabulary)
                 free (vocabulary->texts[i]);
         }
         free (vocabulary->texts);
+        free (vocabulary->text_lookup);
         itty_bit_string_list_free (vocabulary->bit_strings);
         itty_bit_string_map_file_free (vocabulary->bit_string_map);
         free (vocabulary);
@@ -100,11 +137,15 @@ char *
 itty_vocabulary_translate_to_text (itty_vocabulary_t *vocabulary,
                                    itty_bit_string_t *bit_string)
 {
-        for (size_t i = 0; i < vocabulary->count; i++) {
-                itty_bit_string_t *current_bit_string = itty_bit_string_list_fetch (vocabulary->bit_strings, i);
-                if (current_bit_string && itty_bit_string_compare (current_bit_string, bit_string) == 0) {
-                        return strdup (vocabulary->texts[i]);
-                }
+        size_t mask = vocabulary->text_lookup_size - 1;
+        size_t slot = itty_bit_string_get_hash (bit_string) & mask;
+
+        for (; vocabulary->text_lookup[slot] != 0; slot = (slot + 1) & mask) {
+                size_t index = vocabulary->text_lookup[slot] - 1;
+                itty_bit_string_t *current_bit_string = itty_bit_string_list_fetch (vocabulary->bit_strings, index);
+
+                if (itty_bit_string_equal (current_bit_string, bit_string))
+                        return strdup (vocabulary->texts[index]);
         }
         return NULL;
 }
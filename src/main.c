@@ -87,24 +87,37 @@ run_inference (const char *vocabulary_text_file,
         itty_network_t *network = itty_network_new ();
 
         for (size_t i = 0; i < number_of_layers; i++) {
-                itty_bit_string_list_t *bit_string_list;
                 size_t number_of_nodes = 0;
                 size_t number_of_words = 1 << i;
 
+                /* Each layer starts with a header word: how many positions its attention selects, or 0 for none */
+                itty_bit_string_t *header = itty_bit_string_map_file_next (model_map_file, 1);
+                if (!header) {
+                        fprintf (stderr, "Model insufficient size\n");
+                        exit (EXIT_FAILURE);
+                }
+                size_t attention_positions = ((size_t *) itty_bit_string_get_words (header))[0];
+                itty_bit_string_free (header);
+
+                if (attention_positions > 0) {
+                        itty_bit_matrix_t *attention_masks = itty_bit_string_map_file_next_matrix (model_map_file, 2, number_of_words);
+                        if (!attention_masks) {
+                                fprintf (stderr, "Model insufficient size\n");
+                                exit (EXIT_FAILURE);
+                        }
+
+                        itty_network_append (network, itty_network_layer_new_attention (attention_masks, attention_positions));
+                }
+
                 itty_network_layer_t *layer = itty_network_layer_new ();
                 while (number_of_nodes < nodes_per_layer) {
-                        bit_string_list = itty_bit_string_list_new ();
-                        for (size_t j = 0; j < inputs_per_node; j++) {
-                                itty_bit_string_t *bit_string = itty_bit_string_map_file_next (model_map_file, number_of_words);
-                                if (!bit_string) {
-                                        fprintf (stderr, "Model insufficient size\n");
-                                        exit (EXIT_FAILURE);
-                                }
-
-                                itty_bit_string_list_append (bit_string_list, bit_string);
+                        itty_bit_matrix_t *matrix = itty_bit_string_map_file_next_matrix (model_map_file, inputs_per_node, number_of_words);
+                        if (!matrix) {
+                                fprintf (stderr, "Model insufficient size\n");
+                                exit (EXIT_FAILURE);
                         }
 
-                        itty_network_node_t *node = itty_network_node_new (bit_string_list);
+                        itty_network_node_t *node = itty_network_node_new_for_matrix (matrix);
                         itty_network_layer_append (layer, node);
                         number_of_nodes++;
                 }
@@ -114,7 +127,7 @@ run_inference (const char *vocabulary_text_file,
 
         size_t index;
         itty_bit_string_list_t *output_list = itty_network_feed (network, input_list);
-        itty_bit_string_list_popcount_argmax (output_list, itty_bit_string_list_get_max_number_of_words (output_list), &index);
+        itty_bit_string_list_get_pop_count_argmax (output_list, &index);
 
         printf ("Output bit strings:\n");
         itty_bit_string_list_iterator_t iterator;
@@ -0,0 +1,144 @@
+#include <assert.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "itty-arena.h"
+#include "itty-arena-private.h"
+#include "itty-bit-string.h"
+#include "itty-bit-string-private.h"
+#include "itty-bit-string-list.h"
+#include "itty-bit-string-list-private.h"
+
+void
+test_itty_arena_allocate (void)
+{
+        itty_arena_t *arena = itty_arena_new ();
+
+        char *first = itty_arena_allocate (arena, 3);
+        char *second = itty_arena_allocate (arena, 17);
+        assert (((uintptr_t) first % alignof (max_align_t)) == 0);
+        assert (((uintptr_t) second % alignof (max_align_t)) == 0);
+        assert (second >= first + 3);
+        memset (first, 0xff, 3);
+        memset (second, 0xff, 17);
+
+        char *large = itty_arena_allocate (arena, ITTY_ARENA_MINIMUM_CHUNK_SIZE * 3);
+        assert (large != NULL);
+        memset (large, 0xff, ITTY_ARENA_MINIMUM_CHUNK_SIZE * 3);
+
+        itty_arena_free (arena);
+}
+
+void
+test_itty_arena_allocate_aligned (void)
+{
+        itty_arena_t *arena = itty_arena_new ();
+
+        itty_arena_allocate (arena, 8);
+        for (size_t i = 0; i < 8; i++) {
+                char *memory = itty_arena_allocate_aligned (arena, 24, 64);
+                assert (((uintptr_t) memory % 64) == 0);
+                memset (memory, 0xff, 24);
+        }
+
+        itty_arena_free (arena);
+}
+
+void
+test_itty_arena_reset (void)
+{
+        itty_arena_t *arena = itty_arena_new ();
+
+        void *first = itty_arena_allocate (arena, 64);
+        itty_arena_reset (arena);
+        assert (itty_arena_allocate (arena, 64) == first);
+
+        for (size_t i = 0; i < 4; i++)
+                itty_arena_allocate (arena, ITTY_ARENA_MINIMUM_CHUNK_SIZE);
+        size_t total_size = arena->total_size;
+        assert (arena->chunks->next != NULL);
+
+        itty_arena_reset (arena);
+        assert (arena->chunks->next == NULL);
+        assert (arena->total_size == total_size);
+
+        itty_arena_chunk_t *chunk = arena->chunks;
+        for (size_t i = 0; i < 4; i++)
+                itty_arena_allocate (arena, ITTY_ARENA_MINIMUM_CHUNK_SIZE);
+        assert (arena->chunks == chunk);
+
+        itty_arena_free (arena);
+}
+
+void
+test_itty_arena_thread_default (void)
+{
+        itty_arena_t *outer = itty_arena_new ();
+        itty_arena_t *inner = itty_arena_new ();
+
+        assert (itty_arena_get_thread_default () == NULL);
+        itty_arena_t *first_previous = itty_arena_push_thread_default (outer);
+        assert (itty_arena_get_thread_default () == outer);
+        itty_arena_t *second_previous = itty_arena_push_thread_default (inner);
+        assert (itty_arena_get_thread_default () == inner);
+        itty_arena_t *third_previous = itty_arena_push_thread_default (outer);
+        assert (itty_arena_get_thread_default () == outer);
+        itty_arena_pop_thread_default (outer, third_previous);
+        assert (itty_arena_get_thread_default () == inner);
+        itty_arena_pop_thread_default (inner, second_previous);
+        assert (itty_arena_get_thread_default () == outer);
+        itty_arena_pop_thread_default (outer, first_previous);
+        assert (itty_arena_get_thread_default () == NULL);
+
+        itty_arena_free (inner);
+        itty_arena_free (outer);
+}
+
+void
+test_itty_arena_bit_strings (void)
+{
+        itty_arena_t *arena = itty_arena_new ();
+
+        itty_arena_t *previous_arena = itty_arena_push_thread_default (arena);
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+        for (size_t i = 0; i < 10; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                for (size_t j = 0; j <= i; j++)
+                        itty_bit_string_append_word (bit_string, j + 1);
+                itty_bit_string_list_append (list, bit_string);
+        }
+        itty_arena_pop_thread_default (arena, previous_arena);
+
+        assert (list->arena == arena);
+        assert (list->count == 10);
+        assert (list->bit_strings[9]->arena == arena);
+        assert (list->bit_strings[9]->number_of_words == 10);
+        assert (list->bit_strings[9]->words[9] == 10);
+
+        itty_bit_string_t *copy = itty_bit_string_copy (list->bit_strings[9]);
+        assert (copy->arena == NULL);
+        assert (copy->mutability == ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        assert (copy->number_of_words == 10);
+        assert (memcmp (copy->words, list->bit_strings[9]->words, 10 * sizeof (size_t)) == 0);
+
+        itty_bit_string_list_free (list);
+        itty_arena_free (arena);
+
+        assert (copy->words[9] == 10);
+        itty_bit_string_free (copy);
+}
+
+int
+main (void)
+{
+        test_itty_arena_allocate ();
+        test_itty_arena_allocate_aligned ();
+        test_itty_arena_reset ();
+        test_itty_arena_thread_default ();
+        test_itty_arena_bit_strings ();
+
+        printf ("All itty-arena tests passed.\n");
+        return 0;
+}
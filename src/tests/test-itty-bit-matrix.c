@@ -0,0 +1,231 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "itty-bit-matrix.h"
+#include "itty-bit-matrix-private.h"
+#include "itty-bit-string.h"
+#include "itty-bit-string-private.h"
+#include "itty-bit-string-list.h"
+#include "test-itty-random.h"
+
+static itty_bit_matrix_t *
+new_random_matrix (size_t number_of_rows,
+                   size_t number_of_words)
+{
+        itty_bit_matrix_t *matrix = itty_bit_matrix_new (number_of_rows, number_of_words);
+
+        for (size_t i = 0; i < number_of_rows * number_of_words; i++)
+                matrix->storage->words[i] = random_word ();
+
+        return matrix;
+}
+
+static bool
+get_bit (const size_t *words,
+         size_t        bit_index)
+{
+        return (words[bit_index / 64] >> (bit_index % 64)) & 1;
+}
+
+void
+test_itty_bit_matrix_new (void)
+{
+        itty_bit_matrix_t *matrix = itty_bit_matrix_new (5, 3);
+
+        assert (itty_bit_matrix_get_number_of_rows (matrix) == 5);
+        assert (itty_bit_matrix_get_number_of_words (matrix) == 3);
+        assert (((uintptr_t) itty_bit_matrix_get_row_words (matrix, 0) % ITTY_BIT_STRING_ALIGNMENT) == 0);
+        assert (itty_bit_matrix_get_row_words (matrix, 1) == itty_bit_matrix_get_row_words (matrix, 0) + 3);
+
+        for (size_t row = 0; row < 5; row++)
+                for (size_t i = 0; i < 3; i++)
+                        assert (itty_bit_matrix_get_row_words (matrix, row)[i] == 0);
+
+        itty_bit_matrix_free (matrix);
+}
+
+void
+test_itty_bit_matrix_rows (void)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+        itty_bit_string_t *short_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_t *long_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+        itty_bit_string_append_word (short_string, 0x1);
+        itty_bit_string_append_word (long_string, 0x2);
+        itty_bit_string_append_word (long_string, 0x3);
+        itty_bit_string_list_append (list, short_string);
+        itty_bit_string_list_append (list, long_string);
+
+        itty_bit_matrix_t *matrix = itty_bit_matrix_new_from_list (list);
+        assert (itty_bit_matrix_get_number_of_rows (matrix) == 2);
+        assert (itty_bit_matrix_get_number_of_words (matrix) == 2);
+        assert (itty_bit_matrix_get_row_words (matrix, 0)[0] == 0x1);
+        assert (itty_bit_matrix_get_row_words (matrix, 0)[1] == 0);
+        assert (itty_bit_matrix_get_row_words (matrix, 1)[1] == 0x3);
+
+        /* Rows are views that keep their contents when the matrix changes */
+        itty_bit_string_t *row = itty_bit_matrix_get_row (matrix, 1);
+        const size_t *words = itty_bit_string_get_words (row);
+        assert (words == itty_bit_matrix_get_row_words (matrix, 1));
+
+        itty_bit_matrix_set_row (matrix, 1, short_string);
+        assert (itty_bit_matrix_get_row_words (matrix, 1)[0] == 0x1);
+        assert (itty_bit_matrix_get_row_words (matrix, 1)[1] == 0);
+        assert (itty_bit_string_equal (row, long_string));
+        itty_bit_string_unref (row);
+
+        itty_bit_string_list_t *rows = itty_bit_matrix_get_rows (matrix);
+        itty_bit_matrix_free (matrix);
+        assert (itty_bit_string_list_get_length (rows) == 2);
+        assert (itty_bit_string_get_pop_count (itty_bit_string_list_fetch (rows, 1)) == 1);
+        itty_bit_string_list_free (rows);
+
+        itty_bit_string_list_free (list);
+}
+
+void
+test_itty_bit_matrix_operations (void)
+{
+        size_t shapes[][2] = { { 1, 1 }, { 37, 1 }, { 4, 2 }, { 9, 5 }, { 3, 16 } };
+        size_t pop_counts[37];
+
+        srand (1);
+
+        for (size_t shape = 0; shape < sizeof (shapes) / sizeof (shapes[0]); shape++) {
+                size_t number_of_rows = shapes[shape][0];
+                size_t number_of_words = shapes[shape][1];
+                itty_bit_matrix_t *a = new_random_matrix (number_of_rows, number_of_words);
+                itty_bit_matrix_t *b = new_random_matrix (number_of_rows, number_of_words);
+                itty_bit_matrix_t *exclusive_or = itty_bit_matrix_exclusive_or (a, b);
+                itty_bit_matrix_t *mask = itty_bit_matrix_mask (a, b);
+
+                itty_bit_matrix_get_pop_counts (a, pop_counts);
+
+                for (size_t row = 0; row < number_of_rows; row++) {
+                        const size_t *a_words = itty_bit_matrix_get_row_words (a, row);
+                        const size_t *b_words = itty_bit_matrix_get_row_words (b, row);
+                        size_t pop_count = 0;
+
+                        for (size_t i = 0; i < number_of_words; i++) {
+                                assert (itty_bit_matrix_get_row_words (exclusive_or, row)[i] == (a_words[i] ^ b_words[i]));
+                                assert (itty_bit_matrix_get_row_words (mask, row)[i] == (a_words[i] & b_words[i]));
+                                pop_count += __builtin_popcountl (a_words[i]);
+                        }
+                        assert (pop_counts[row] == pop_count);
+                }
+
+                itty_bit_matrix_exclusive_or_into (a, a, a);
+                for (size_t row = 0; row < number_of_rows; row++)
+                        for (size_t i = 0; i < number_of_words; i++)
+                                assert (itty_bit_matrix_get_row_words (a, row)[i] == 0);
+
+                itty_bit_matrix_free (a);
+                itty_bit_matrix_free (b);
+                itty_bit_matrix_free (exclusive_or);
+                itty_bit_matrix_free (mask);
+        }
+}
+
+void
+test_itty_bit_matrix_exclusive_or_list (void)
+{
+        itty_bit_matrix_t *matrix = new_random_matrix (3, 1);
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+
+        for (size_t i = 0; i < 4; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                for (size_t j = 0; j <= i % 2; j++)
+                        itty_bit_string_append_word (bit_string, random_word ());
+                itty_bit_string_list_append (list, bit_string);
+        }
+
+        itty_bit_matrix_t *result = itty_bit_matrix_exclusive_or_list (matrix, list);
+        assert (itty_bit_matrix_get_number_of_rows (result) == 3);
+        assert (itty_bit_matrix_get_number_of_words (result) == 2);
+
+        for (size_t row = 0; row < 3; row++) {
+                itty_bit_string_t *mask = itty_bit_matrix_get_row (matrix, row);
+                itty_bit_string_t *expected = itty_bit_string_exclusive_or (itty_bit_string_list_fetch (list, row), mask);
+                const size_t *expected_words = itty_bit_string_get_words (expected);
+                size_t number_of_expected_words = itty_bit_string_get_number_of_words (expected);
+
+                for (size_t i = 0; i < 2; i++)
+                        assert (itty_bit_matrix_get_row_words (result, row)[i] == (i < number_of_expected_words ? expected_words[i] : 0));
+
+                itty_bit_string_unref (mask);
+                itty_bit_string_unref (expected);
+        }
+
+        itty_bit_matrix_free (result);
+        itty_bit_matrix_free (matrix);
+        itty_bit_string_list_free (list);
+}
+
+void
+test_itty_bit_matrix_transpose (void)
+{
+        size_t shapes[][2] = { { 1, 1 }, { 64, 1 }, { 70, 2 }, { 130, 3 } };
+
+        srand (2);
+
+        for (size_t shape = 0; shape < sizeof (shapes) / sizeof (shapes[0]); shape++) {
+                size_t number_of_rows = shapes[shape][0];
+                size_t number_of_words = shapes[shape][1];
+                itty_bit_matrix_t *matrix = new_random_matrix (number_of_rows, number_of_words);
+                itty_bit_matrix_t *transposed = itty_bit_matrix_transpose (matrix);
+
+                assert (itty_bit_matrix_get_number_of_rows (transposed) == number_of_words * 64);
+                assert (itty_bit_matrix_get_number_of_words (transposed) == (number_of_rows + 63) / 64);
+
+                for (size_t i = 0; i < number_of_words * 64; i++) {
+                        const size_t *row_words = itty_bit_matrix_get_row_words (transposed, i);
+
+                        for (size_t j = 0; j < itty_bit_matrix_get_number_of_words (transposed) * 64; j++) {
+                                bool expected = j < number_of_rows && get_bit (itty_bit_matrix_get_row_words (matrix, j), i);
+                                assert (get_bit (row_words, j) == expected);
+                        }
+                }
+
+                itty_bit_matrix_t *round_trip = itty_bit_matrix_transpose (transposed);
+                for (size_t row = 0; row < number_of_rows; row++)
+                        assert (memcmp (itty_bit_matrix_get_row_words (round_trip, row),
+                                        itty_bit_matrix_get_row_words (matrix, row),
+                                        number_of_words * sizeof (size_t)) == 0);
+
+                itty_bit_matrix_free (round_trip);
+                itty_bit_matrix_free (transposed);
+                itty_bit_matrix_free (matrix);
+        }
+}
+
+void
+test_itty_bit_matrix_arena (void)
+{
+        itty_arena_t *arena = itty_arena_new ();
+
+        itty_arena_t *previous_arena = itty_arena_push_thread_default (arena);
+        itty_bit_matrix_t *matrix = itty_bit_matrix_new (10, 2);
+        assert (matrix->arena == arena);
+        assert (matrix->storage->arena == arena);
+        itty_bit_matrix_free (matrix);
+        itty_arena_pop_thread_default (arena, previous_arena);
+
+        itty_arena_free (arena);
+}
+
+int
+main (void)
+{
+        test_itty_bit_matrix_new ();
+        test_itty_bit_matrix_rows ();
+        test_itty_bit_matrix_operations ();
+        test_itty_bit_matrix_exclusive_or_list ();
+        test_itty_bit_matrix_transpose ();
+        test_itty_bit_matrix_arena ();
+
+        printf ("All itty-bit-matrix tests passed.\n");
+        return 0;
+}
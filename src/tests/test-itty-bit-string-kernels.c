@@ -0,0 +1,328 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "itty-bit-string.h"
+#include "itty-bit-string-kernels-private.h"
+#include "test-itty-random.h"
+
+#define TEST_MAX_NUMBER_OF_WORDS 37
+#define TEST_MAX_NUMBER_OF_POP_COUNT_WORDS 300
+
+static void
+fill_with_random_words (size_t *words,
+                        size_t  number_of_words)
+{
+        for (size_t i = 0; i < number_of_words; i++) {
+                words[i] = random_word ();
+        }
+}
+
+static void
+check_binary_kernel (itty_bit_string_binary_kernel_t kernel,
+                     itty_bit_string_binary_kernel_t reference_kernel)
+{
+        size_t a[TEST_MAX_NUMBER_OF_WORDS];
+        size_t b[TEST_MAX_NUMBER_OF_WORDS];
+        size_t result[TEST_MAX_NUMBER_OF_WORDS];
+        size_t expected[TEST_MAX_NUMBER_OF_WORDS];
+
+        for (size_t number_of_words = 0; number_of_words <= TEST_MAX_NUMBER_OF_WORDS; number_of_words++) {
+                fill_with_random_words (a, TEST_MAX_NUMBER_OF_WORDS);
+                fill_with_random_words (b, TEST_MAX_NUMBER_OF_WORDS);
+                memset (result, 0xaa, sizeof (result));
+                memset (expected, 0xaa, sizeof (expected));
+
+                reference_kernel (expected, a, b, number_of_words);
+                kernel (result, a, b, number_of_words);
+                assert (memcmp (result, expected, sizeof (result)) == 0);
+
+                kernel (a, a, b, number_of_words);
+                assert (memcmp (a, expected, number_of_words * sizeof (size_t)) == 0);
+        }
+}
+
+static void
+check_binary_pop_count_kernel (itty_bit_string_binary_pop_count_kernel_t pop_count_kernel,
+                               itty_bit_string_binary_kernel_t           reference_kernel)
+{
+        size_t a[TEST_MAX_NUMBER_OF_WORDS];
+        size_t b[TEST_MAX_NUMBER_OF_WORDS];
+        size_t expected[TEST_MAX_NUMBER_OF_WORDS];
+
+        for (size_t number_of_words = 0; number_of_words <= TEST_MAX_NUMBER_OF_WORDS; number_of_words++) {
+                size_t expected_pop_count = 0;
+
+                fill_with_random_words (a, TEST_MAX_NUMBER_OF_WORDS);
+                fill_with_random_words (b, TEST_MAX_NUMBER_OF_WORDS);
+
+                reference_kernel (expected, a, b, number_of_words);
+                for (size_t i = 0; i < number_of_words; i++)
+                        expected_pop_count += __builtin_popcountl (expected[i]);
+
+                assert (pop_count_kernel (a, b, number_of_words) == expected_pop_count);
+        }
+}
+
+static void
+check_pop_count_kernel (itty_bit_string_pop_count_kernel_t pop_count_kernel)
+{
+        size_t words[TEST_MAX_NUMBER_OF_POP_COUNT_WORDS + 1];
+
+        fill_with_random_words (words, TEST_MAX_NUMBER_OF_POP_COUNT_WORDS + 1);
+
+        for (size_t number_of_words = 0; number_of_words <= TEST_MAX_NUMBER_OF_POP_COUNT_WORDS; number_of_words++) {
+                for (size_t offset = 0; offset <= 1; offset++) {
+                        size_t expected_pop_count = 0;
+
+                        for (size_t i = 0; i < number_of_words; i++)
+                                expected_pop_count += __builtin_popcountl (words[offset + i]);
+
+                        assert (pop_count_kernel (words + offset, number_of_words) == expected_pop_count);
+                }
+        }
+
+        memset (words, 0xff, sizeof (words));
+        assert (pop_count_kernel (words, TEST_MAX_NUMBER_OF_POP_COUNT_WORDS) == TEST_MAX_NUMBER_OF_POP_COUNT_WORDS * ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+}
+
+static void
+check_funnel_shift_kernel (itty_bit_string_funnel_shift_kernel_t funnel_shift_kernel,
+                           itty_bit_string_funnel_shift_kernel_t reference_kernel)
+{
+        size_t words[TEST_MAX_NUMBER_OF_WORDS + 1];
+        size_t result[TEST_MAX_NUMBER_OF_WORDS];
+        size_t expected[TEST_MAX_NUMBER_OF_WORDS];
+
+        for (size_t number_of_words = 0; number_of_words <= TEST_MAX_NUMBER_OF_WORDS; number_of_words++) {
+                for (unsigned int shift = 1; shift < ITTY_BIT_STRING_WORD_SIZE_IN_BITS; shift += 7) {
+                        fill_with_random_words (words, TEST_MAX_NUMBER_OF_WORDS + 1);
+                        memset (result, 0xaa, sizeof (result));
+                        memset (expected, 0xaa, sizeof (expected));
+
+                        reference_kernel (expected, words, words + 1, number_of_words, shift);
+                        funnel_shift_kernel (result, words, words + 1, number_of_words, shift);
+                        assert (memcmp (result, expected, sizeof (result)) == 0);
+
+                        funnel_shift_kernel (words, words, words + 1, number_of_words, shift);
+                        assert (memcmp (words, expected, number_of_words * sizeof (size_t)) == 0);
+                }
+        }
+}
+
+static void
+check_pop_count_each_word_kernel (itty_bit_string_pop_count_each_word_kernel_t pop_count_each_word_kernel)
+{
+        size_t words[TEST_MAX_NUMBER_OF_WORDS];
+        size_t pop_counts[TEST_MAX_NUMBER_OF_WORDS];
+
+        for (size_t number_of_words = 0; number_of_words <= TEST_MAX_NUMBER_OF_WORDS; number_of_words++) {
+                fill_with_random_words (words, TEST_MAX_NUMBER_OF_WORDS);
+                memset (pop_counts, 0xaa, sizeof (pop_counts));
+
+                pop_count_each_word_kernel (pop_counts, words, number_of_words);
+                for (size_t i = 0; i < number_of_words; i++)
+                        assert (pop_counts[i] == (size_t) __builtin_popcountl (words[i]));
+                for (size_t i = number_of_words; i < TEST_MAX_NUMBER_OF_WORDS; i++)
+                        assert (pop_counts[i] == (size_t) 0xaaaaaaaaaaaaaaaa);
+        }
+}
+
+static void
+check_transpose_kernel (itty_bit_string_transpose_kernel_t transpose_kernel)
+{
+        size_t words[ITTY_BIT_STRING_WORD_SIZE_IN_BITS];
+        size_t transposed[ITTY_BIT_STRING_WORD_SIZE_IN_BITS];
+
+        for (int round = 0; round < 8; round++) {
+                fill_with_random_words (words, ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+                memcpy (transposed, words, sizeof (words));
+
+                transpose_kernel (transposed);
+                for (size_t i = 0; i < ITTY_BIT_STRING_WORD_SIZE_IN_BITS; i++) {
+                        for (size_t j = 0; j < ITTY_BIT_STRING_WORD_SIZE_IN_BITS; j++)
+                                assert (((transposed[i] >> j) & 1) == ((words[j] >> i) & 1));
+                }
+
+                transpose_kernel (transposed);
+                assert (memcmp (transposed, words, sizeof (words)) == 0);
+        }
+}
+
+static void
+check_exclusive_or_pop_count_tile_kernel (itty_bit_string_exclusive_or_pop_count_tile_kernel_t kernel)
+{
+        size_t rows[ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * TEST_MAX_NUMBER_OF_WORDS];
+        size_t columns[ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS][TEST_MAX_NUMBER_OF_WORDS];
+        size_t interleaved[TEST_MAX_NUMBER_OF_WORDS * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS];
+        uint32_t pop_counts[ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS];
+
+        for (size_t number_of_words = 0; number_of_words <= TEST_MAX_NUMBER_OF_WORDS; number_of_words++) {
+                fill_with_random_words (rows, ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS * number_of_words);
+                for (size_t j = 0; j < ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS; j++) {
+                        fill_with_random_words (columns[j], number_of_words);
+                        for (size_t k = 0; k < number_of_words; k++)
+                                interleaved[k * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS + j] = columns[j][k];
+                }
+
+                kernel (pop_counts, rows, interleaved, number_of_words);
+                for (size_t i = 0; i < ITTY_BIT_STRING_TILE_NUMBER_OF_ROWS; i++) {
+                        for (size_t j = 0; j < ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS; j++) {
+                                size_t expected = 0;
+
+                                for (size_t k = 0; k < number_of_words; k++)
+                                        expected += __builtin_popcountl (rows[i * number_of_words + k] ^ columns[j][k]);
+                                assert (pop_counts[i * ITTY_BIT_STRING_TILE_NUMBER_OF_COLUMNS + j] == expected);
+                        }
+                }
+        }
+}
+
+void
+test_itty_bit_string_kernels_agree_with_scalar (void)
+{
+        const itty_bit_string_kernels_t *scalar = itty_bit_string_kernels_get_for_level (ITTY_BIT_STRING_KERNEL_LEVEL_SCALAR);
+        assert (scalar != NULL);
+
+        for (int level = ITTY_BIT_STRING_KERNEL_LEVEL_SCALAR; level < ITTY_BIT_STRING_NUMBER_OF_KERNEL_LEVELS; level++) {
+                const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get_for_level (level);
+
+                if (kernels == NULL)
+                        continue;
+
+                printf ("Testing %s kernels\n", kernels->name);
+                check_binary_kernel (kernels->exclusive_nor, scalar->exclusive_nor);
+                check_binary_kernel (kernels->exclusive_or, scalar->exclusive_or);
+                check_binary_kernel (kernels->combine, scalar->combine);
+                check_binary_kernel (kernels->mask, scalar->mask);
+                check_pop_count_kernel (kernels->pop_count);
+                check_pop_count_each_word_kernel (kernels->pop_count_each_word);
+                check_binary_pop_count_kernel (kernels->exclusive_nor_pop_count, scalar->exclusive_nor);
+                check_binary_pop_count_kernel (kernels->exclusive_or_pop_count, scalar->exclusive_or);
+                check_binary_pop_count_kernel (kernels->mask_pop_count, scalar->mask);
+                check_funnel_shift_kernel (kernels->funnel_shift, scalar->funnel_shift);
+                check_transpose_kernel (kernels->transpose);
+                check_exclusive_or_pop_count_tile_kernel (kernels->exclusive_or_pop_count_tile);
+        }
+}
+
+void
+test_itty_bit_string_kernels_scalar (void)
+{
+        const itty_bit_string_kernels_t *scalar = itty_bit_string_kernels_get_for_level (ITTY_BIT_STRING_KERNEL_LEVEL_SCALAR);
+        size_t a[] = { 0b1100, 0 };
+        size_t b[] = { 0b1010, ~0UL };
+        size_t result[2];
+
+        scalar->exclusive_nor (result, a, b, 2);
+        assert (result[0] == ~0b0110UL && result[1] == 0);
+        scalar->exclusive_or (result, a, b, 2);
+        assert (result[0] == 0b0110 && result[1] == ~0UL);
+        scalar->combine (result, a, b, 2);
+        assert (result[0] == 0b1110 && result[1] == ~0UL);
+        scalar->mask (result, a, b, 2);
+        assert (result[0] == 0b1000 && result[1] == 0);
+        scalar->funnel_shift (result, b, b + 1, 1, 4);
+        assert (result[0] == 0b10101111);
+}
+
+static void
+check_fixed_width_binary_kernel (itty_bit_string_binary_kernel_t kernel,
+                                 itty_bit_string_binary_kernel_t reference_kernel,
+                                 size_t                          number_of_words)
+{
+        size_t a[TEST_MAX_NUMBER_OF_WORDS];
+        size_t b[TEST_MAX_NUMBER_OF_WORDS];
+        size_t result[TEST_MAX_NUMBER_OF_WORDS];
+        size_t expected[TEST_MAX_NUMBER_OF_WORDS];
+
+        fill_with_random_words (a, TEST_MAX_NUMBER_OF_WORDS);
+        fill_with_random_words (b, TEST_MAX_NUMBER_OF_WORDS);
+        memset (result, 0xaa, sizeof (result));
+        memset (expected, 0xaa, sizeof (expected));
+
+        reference_kernel (expected, a, b, number_of_words);
+        kernel (result, a, b, 0);
+        assert (memcmp (result, expected, sizeof (result)) == 0);
+}
+
+static void
+check_fixed_width_pop_count_kernels (const itty_bit_string_kernels_t *kernels,
+                                     const itty_bit_string_kernels_t *scalar)
+{
+        size_t number_of_words = kernels->number_of_words;
+        size_t a[TEST_MAX_NUMBER_OF_WORDS];
+        size_t b[TEST_MAX_NUMBER_OF_WORDS];
+
+        fill_with_random_words (a, TEST_MAX_NUMBER_OF_WORDS);
+        fill_with_random_words (b, TEST_MAX_NUMBER_OF_WORDS);
+
+        assert (kernels->pop_count (a, 0) == scalar->pop_count (a, number_of_words));
+        assert (kernels->exclusive_nor_pop_count (a, b, 0) == scalar->exclusive_nor_pop_count (a, b, number_of_words));
+        assert (kernels->exclusive_or_pop_count (a, b, 0) == scalar->exclusive_or_pop_count (a, b, number_of_words));
+        assert (kernels->mask_pop_count (a, b, 0) == scalar->mask_pop_count (a, b, number_of_words));
+}
+
+void
+test_itty_bit_string_kernels_fixed_width (void)
+{
+        const itty_bit_string_kernels_t *scalar = itty_bit_string_kernels_get_for_level (ITTY_BIT_STRING_KERNEL_LEVEL_SCALAR);
+
+        for (int level = 0; level < ITTY_BIT_STRING_NUMBER_OF_KERNEL_LEVELS; level++) {
+                if (itty_bit_string_kernels_get_for_level (level) == NULL) {
+                        assert (itty_bit_string_kernels_get_for_level_and_width (level, 4) == NULL);
+                        continue;
+                }
+
+                for (size_t number_of_words = 1; number_of_words <= ITTY_BIT_STRING_KERNELS_MAXIMUM_FIXED_WIDTH; number_of_words <<= 1) {
+                        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get_for_level_and_width (level, number_of_words);
+
+                        assert (kernels != NULL);
+                        assert (kernels->level == (itty_bit_string_kernel_level_t) level);
+                        assert (kernels->number_of_words == number_of_words);
+                        assert (kernels->exclusive_or_pop_count_tile == itty_bit_string_kernels_get_for_level (level)->exclusive_or_pop_count_tile);
+
+                        for (int i = 0; i < 10; i++) {
+                                check_fixed_width_binary_kernel (kernels->exclusive_nor, scalar->exclusive_nor, number_of_words);
+                                check_fixed_width_binary_kernel (kernels->exclusive_or, scalar->exclusive_or, number_of_words);
+                                check_fixed_width_binary_kernel (kernels->combine, scalar->combine, number_of_words);
+                                check_fixed_width_binary_kernel (kernels->mask, scalar->mask, number_of_words);
+                                check_fixed_width_pop_count_kernels (kernels, scalar);
+                        }
+                }
+
+                assert (itty_bit_string_kernels_get_for_level_and_width (level, 0) == NULL);
+                assert (itty_bit_string_kernels_get_for_level_and_width (level, 3) == NULL);
+                assert (itty_bit_string_kernels_get_for_level_and_width (level, ITTY_BIT_STRING_KERNELS_MAXIMUM_FIXED_WIDTH * 2) == NULL);
+        }
+
+        assert (itty_bit_string_kernels_get_for_width (3) == itty_bit_string_kernels_get ());
+        assert (itty_bit_string_kernels_get_for_width (8)->number_of_words == 8);
+        assert (itty_bit_string_kernels_get_for_width (8)->level == itty_bit_string_kernels_get ()->level);
+}
+
+void
+test_itty_bit_string_kernels_get (void)
+{
+        const itty_bit_string_kernels_t *kernels = itty_bit_string_kernels_get ();
+        assert (kernels != NULL);
+        assert (kernels == itty_bit_string_kernels_get_for_level (kernels->level));
+
+        for (int level = kernels->level + 1; level < ITTY_BIT_STRING_NUMBER_OF_KERNEL_LEVELS; level++) {
+                assert (itty_bit_string_kernels_get_for_level (level) == NULL);
+        }
+
+        printf ("Using %s kernels\n", kernels->name);
+}
+
+int
+main (void)
+{
+        test_itty_bit_string_kernels_scalar ();
+        test_itty_bit_string_kernels_agree_with_scalar ();
+        test_itty_bit_string_kernels_fixed_width ();
+        test_itty_bit_string_kernels_get ();
+
+        printf ("All itty-bit-string-kernels tests passed.\n");
+        return 0;
+}
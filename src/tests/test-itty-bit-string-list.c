@@ -6,6 +6,7 @@
 #include "itty-bit-string-private.h"
 #include "itty-bit-string-list.h"
 #include "itty-bit-string-list-private.h"
+#include "test-itty-random.h"
 
 void
 test_itty_bit_string_list_new (void)
@@ -76,6 +77,48 @@ test_itty_bit_string_list_condense (void)
         itty_bit_string_list_free (list);
 }
 
+void
+test_itty_bit_string_list_condense_with_threshold (void)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+        size_t number_of_strings = 37;
+        size_t number_of_words = 70;
+
+        srand (17);
+        for (size_t i = 0; i < number_of_strings; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                size_t length = i % 5 == 0 ? number_of_words - i : number_of_words;
+
+                for (size_t j = 0; j < length; j++)
+                        itty_bit_string_append_word (bit_string, random_word ());
+                itty_bit_string_list_append (list, bit_string);
+        }
+
+        size_t thresholds[] = { 0, 1, 10, 19, 37, 38, 100 };
+        for (size_t t = 0; t < sizeof (thresholds) / sizeof (thresholds[0]); t++) {
+                itty_bit_string_t *condensed = itty_bit_string_list_condense_with_threshold (list, thresholds[t]);
+                assert (itty_bit_string_get_number_of_words (condensed) == number_of_words);
+
+                for (size_t j = 0; j < number_of_words; j++) {
+                        for (size_t bit = 0; bit < ITTY_BIT_STRING_WORD_SIZE_IN_BITS; bit++) {
+                                size_t count = 0;
+
+                                for (size_t i = 0; i < number_of_strings; i++) {
+                                        itty_bit_string_t *bit_string = itty_bit_string_list_fetch (list, i);
+                                        if (j < bit_string->number_of_words)
+                                                count += (bit_string->words[j] >> bit) & 1;
+                                }
+
+                                assert (((condensed->words[j] >> bit) & 1) == (count >= thresholds[t]));
+                        }
+                }
+
+                itty_bit_string_free (condensed);
+        }
+
+        itty_bit_string_list_free (list);
+}
+
 void
 test_itty_bit_string_list_sort (void)
 {
@@ -98,6 +141,120 @@ test_itty_bit_string_list_sort (void)
         itty_bit_string_list_free (list);
 }
 
+void
+test_itty_bit_string_list_get_sorted_indices (void)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+        size_t number_of_bit_strings = 500;
+        size_t *indices = malloc (number_of_bit_strings * sizeof (size_t));
+        size_t top[8];
+
+        for (size_t i = 0; i < number_of_bit_strings; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+                for (size_t j = 0; j < 6; j++)
+                        itty_bit_string_append_word (bit_string, (i * 37) % 7 > j ? ~0UL >> (i % 64) : 0);
+                itty_bit_string_list_append (list, bit_string);
+        }
+
+        for (int order = ITTY_BIT_STRING_SORT_ORDER_ASCENDING; order <= ITTY_BIT_STRING_SORT_ORDER_DESCENDING; order++) {
+                itty_bit_string_list_get_sorted_indices (list, order, indices);
+
+                for (size_t i = 1; i < number_of_bit_strings; i++) {
+                        size_t previous = itty_bit_string_get_pop_count (list->bit_strings[indices[i - 1]]);
+                        size_t current = itty_bit_string_get_pop_count (list->bit_strings[indices[i]]);
+
+                        if (order == ITTY_BIT_STRING_SORT_ORDER_ASCENDING)
+                                assert (previous < current || (previous == current && indices[i - 1] < indices[i]));
+                        else
+                                assert (previous > current || (previous == current && indices[i - 1] < indices[i]));
+                }
+        }
+
+        assert (itty_bit_string_list_get_top_indices (list, 8, top) == 8);
+        for (size_t i = 0; i < 8; i++)
+                assert (top[i] == indices[i]);
+
+        assert (itty_bit_string_list_get_top_indices (list, 0, top) == 0);
+        itty_bit_string_list_free (list);
+
+        list = itty_bit_string_list_new ();
+        for (size_t i = 0; i < 3; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                itty_bit_string_append_word (bit_string, (1UL << i) - 1);
+                itty_bit_string_list_append (list, bit_string);
+        }
+        assert (itty_bit_string_list_get_top_indices (list, 8, top) == 3);
+        assert (top[0] == 2 && top[1] == 1 && top[2] == 0);
+        itty_bit_string_list_free (list);
+
+        free (indices);
+}
+
+void
+test_itty_bit_string_list_pop_count_argmax (void)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+        size_t pop_counts[] = { 3, 9, 1, 9, 0, 5 };
+        size_t number_of_bit_strings = 200;
+        size_t weights[200];
+        size_t index;
+
+        assert (!itty_bit_string_list_get_pop_count_argmax (list, &index));
+
+        for (size_t i = 0; i < number_of_bit_strings; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                size_t pop_count = i < 6 ? pop_counts[i] : 2 + i % 5;
+
+                itty_bit_string_append_word (bit_string, (1UL << pop_count) - 1);
+                if (i % 3 == 0)
+                        itty_bit_string_append_word (bit_string, 0);
+                itty_bit_string_list_append (list, bit_string);
+        }
+
+        assert (itty_bit_string_list_get_pop_count_argmax (list, &index));
+        assert (index == 1);
+        assert (itty_bit_string_list_get_pop_count_argmin (list, &index));
+        assert (index == 4);
+        assert (itty_bit_string_list_popcount_argmax (list, 1, &index));
+        assert (index == 1);
+
+        size_t total_pop_count = 0;
+        size_t total_weight = 0;
+        for (size_t i = 0; i < number_of_bit_strings; i++)
+                total_pop_count += itty_bit_string_get_pop_count (list->bit_strings[i]);
+
+        itty_bit_string_list_get_pop_count_weights (list, 1000, weights);
+        for (size_t i = 0; i < number_of_bit_strings; i++) {
+                size_t pop_count = itty_bit_string_get_pop_count (list->bit_strings[i]);
+
+                assert (weights[i] * total_pop_count <= pop_count * 1000 + total_pop_count);
+                assert (weights[i] * total_pop_count + total_pop_count >= pop_count * 1000);
+                total_weight += weights[i];
+        }
+        assert (total_weight == 1000);
+
+        itty_bit_string_list_t *softmax = itty_bit_string_list_popcount_softmax (list, 2);
+        assert (itty_bit_string_list_get_length (softmax) == number_of_bit_strings);
+        itty_bit_string_list_get_pop_count_weights (list, 128, weights);
+        total_weight = 0;
+        for (size_t i = 0; i < number_of_bit_strings; i++) {
+                assert (itty_bit_string_get_number_of_words (softmax->bit_strings[i]) == 2);
+                assert (itty_bit_string_get_pop_count (softmax->bit_strings[i]) == weights[i]);
+                total_weight += weights[i];
+        }
+        assert (total_weight == 128);
+        itty_bit_string_list_free (softmax);
+        itty_bit_string_list_free (list);
+
+        list = itty_bit_string_list_new ();
+        for (size_t i = 0; i < 3; i++)
+                itty_bit_string_list_append (list, itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE));
+        itty_bit_string_list_get_pop_count_weights (list, 64, weights);
+        assert (weights[0] == 21 && weights[1] == 21 && weights[2] == 22);
+        itty_bit_string_list_free (list);
+}
+
 void
 test_itty_bit_string_list_transpose (void)
 {
@@ -137,6 +294,356 @@ test_itty_bit_string_list_transpose (void)
         itty_bit_string_list_free (list);
 }
 
+void
+test_itty_bit_string_list_transpose_tiles (void)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+        size_t number_of_strings = 150;
+
+        srand (23);
+        for (size_t i = 0; i < number_of_strings; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                size_t number_of_words = i % 3 + 1;
+
+                for (size_t j = 0; j < number_of_words; j++)
+                        itty_bit_string_append_word (bit_string, random_word ());
+                itty_bit_string_list_append (list, bit_string);
+        }
+
+        size_t bit_length = itty_bit_string_list_get_bit_length (list);
+        itty_bit_string_list_t *transposed_list = itty_bit_string_list_transpose (list);
+        assert (transposed_list->count == bit_length);
+
+        for (size_t row = 0; row < bit_length; row++) {
+                itty_bit_string_t *transposed_bit_string = transposed_list->bit_strings[row];
+                size_t position = bit_length - 1 - row;
+
+                assert (transposed_bit_string->number_of_words == 3);
+                for (size_t i = 0; i < number_of_strings; i++) {
+                        itty_bit_string_t *bit_string = list->bit_strings[i];
+                        size_t word_index = position / ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                        size_t expected = 0;
+
+                        if (word_index < bit_string->number_of_words)
+                                expected = (bit_string->words[word_index] >> (position % ITTY_BIT_STRING_WORD_SIZE_IN_BITS)) & 1;
+
+                        assert (((transposed_bit_string->words[i / ITTY_BIT_STRING_WORD_SIZE_IN_BITS] >> (i % ITTY_BIT_STRING_WORD_SIZE_IN_BITS)) & 1) == expected);
+                }
+        }
+
+        itty_bit_string_list_free (transposed_list);
+        itty_bit_string_list_free (list);
+}
+
+void
+test_itty_bit_string_list_get_pop_counts (void)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+        size_t number_of_bit_strings = 10000;
+
+        for (size_t i = 0; i < number_of_bit_strings; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                size_t number_of_words = i % 7 == 0 ? i % 5 : 1;
+
+                for (size_t j = 0; j < number_of_words; j++)
+                        itty_bit_string_append_word (bit_string, (i * 0x9e3779b97f4a7c15) ^ (j << 17));
+                if (i % 3 == 0)
+                        itty_bit_string_get_pop_count (bit_string);
+
+                itty_bit_string_list_append (list, bit_string);
+        }
+
+        size_t *pop_counts = malloc (number_of_bit_strings * sizeof (size_t));
+        size_t *parallel_pop_counts = malloc (number_of_bit_strings * sizeof (size_t));
+        itty_manager_t *manager = itty_manager_new ();
+
+        itty_bit_string_list_get_pop_counts (list, pop_counts);
+        itty_bit_string_list_get_pop_counts_with_manager (list, parallel_pop_counts, manager);
+
+        for (size_t i = 0; i < number_of_bit_strings; i++) {
+                itty_bit_string_t *bit_string = list->bit_strings[i];
+                size_t expected_pop_count = 0;
+
+                for (size_t j = 0; j < bit_string->number_of_words; j++)
+                        expected_pop_count += __builtin_popcountl (bit_string->words[j]);
+
+                assert (pop_counts[i] == expected_pop_count);
+                assert (parallel_pop_counts[i] == expected_pop_count);
+        }
+
+        itty_manager_free (manager);
+        free (parallel_pop_counts);
+        free (pop_counts);
+        itty_bit_string_list_free (list);
+}
+
+void
+test_itty_bit_string_list_present (void)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+        itty_bit_string_presentation_format_t formats[] = {
+                ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY,
+                ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY,
+                ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL,
+                ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY,
+        };
+        size_t words[][2] = { { 0x5, 0 }, { 0, 0x1f }, { 0xabc, 0 } };
+
+        for (size_t i = 0; i < 3; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                for (size_t j = 0; j <= i % 2; j++)
+                        itty_bit_string_append_word (bit_string, words[i][j]);
+                itty_bit_string_list_append (list, bit_string);
+        }
+
+        char *representation = itty_bit_string_list_present (list, ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY);
+        assert (strcmp (representation, "\t[\n\t\t  0x5\n\t\t0x 1f\n\t\t0xabc\n\t]\n") == 0);
+        free (representation);
+
+        for (size_t i = 0; i < sizeof (formats) / sizeof (formats[0]); i++) {
+                char *expected = itty_bit_string_list_present (list, formats[i]);
+                char streamed[1024] = { 0 };
+                FILE *file = tmpfile ();
+
+                assert (itty_bit_string_list_present_to_file (list, formats[i], file));
+                rewind (file);
+                assert (fread (streamed, 1, sizeof (streamed) - 1, file) == strlen (expected));
+                assert (strcmp (streamed, expected) == 0);
+
+                fclose (file);
+                free (expected);
+        }
+
+        itty_bit_string_list_free (list);
+
+        list = itty_bit_string_list_new ();
+        representation = itty_bit_string_list_present (list, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY);
+        assert (strcmp (representation, "\t[\n\t]\n") == 0);
+        free (representation);
+        itty_bit_string_list_free (list);
+}
+
+static itty_bit_string_list_t *
+new_wide_list (size_t number_of_bit_strings,
+               size_t number_of_words,
+               size_t seed)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+
+        for (size_t i = 0; i < number_of_bit_strings; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+                for (size_t j = 0; j < number_of_words - i % 3; j++)
+                        itty_bit_string_append_word (bit_string, ((i + seed) * 0x9e3779b97f4a7c15) ^ (j * 0xbf58476d1ce4e5b9));
+                itty_bit_string_list_append (list, bit_string);
+        }
+
+        return list;
+}
+
+void
+test_itty_bit_string_list_evaluate_similarities (void)
+{
+        itty_bit_string_list_t *list_a = itty_bit_string_list_new ();
+        itty_bit_string_list_t *list_b = itty_bit_string_list_new ();
+        uint32_t similarities[11 * 13];
+
+        /* Mixed widths, empty strings, and partial tiles on both sides */
+        for (size_t i = 0; i < 11 + 13; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+                for (size_t j = 0; j < i % 6; j++)
+                        itty_bit_string_append_word (bit_string, (i * 0x9e3779b97f4a7c15) ^ (j * 0xbf58476d1ce4e5b9));
+                itty_bit_string_list_append (i < 11 ? list_a : list_b, bit_string);
+        }
+
+        itty_bit_string_list_evaluate_similarities (list_a, list_b, similarities);
+        for (size_t i = 0; i < 11; i++)
+                for (size_t j = 0; j < 13; j++)
+                        assert (similarities[i * 13 + j] == itty_bit_string_evaluate_similarity (list_a->bit_strings[i], list_b->bit_strings[j]));
+
+        itty_bit_string_list_free (list_a);
+        itty_bit_string_list_free (list_b);
+}
+
+static itty_bit_string_list_t *
+new_mixed_width_list (size_t number_of_bit_strings,
+                      size_t seed)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+
+        for (size_t i = 0; i < number_of_bit_strings; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+                for (size_t j = 0; j < 1 + (i + seed) % 3; j++)
+                        itty_bit_string_append_word (bit_string, ((i * 7 + seed) % 5 * 0x9e3779b97f4a7c15) ^ (j * 0xbf58476d1ce4e5b9));
+                itty_bit_string_list_append (list, bit_string);
+        }
+
+        return list;
+}
+
+void
+test_itty_bit_string_list_attend (void)
+{
+        itty_bit_string_list_t *queries = new_mixed_width_list (70, 1);
+        itty_bit_string_list_t *keys = new_mixed_width_list (37, 2);
+        itty_bit_string_list_t *values = new_mixed_width_list (37, 3);
+        bool chosen[37];
+
+        for (size_t number_of_selected = 0; number_of_selected <= 40; number_of_selected += 4) {
+                size_t k = number_of_selected < 37 ? number_of_selected : 37;
+                itty_bit_string_list_t *attended = itty_bit_string_list_attend (queries, keys, values, number_of_selected);
+
+                assert (itty_bit_string_list_get_length (attended) == 70);
+                for (size_t i = 0; i < 70; i++) {
+                        itty_bit_string_t *result = itty_bit_string_list_fetch (attended, i);
+                        size_t counts[3 * ITTY_BIT_STRING_WORD_SIZE_IN_BITS] = { 0 };
+
+                        memset (chosen, 0, sizeof (chosen));
+                        for (size_t n = 0; n < k; n++) {
+                                size_t best = 37;
+
+                                for (size_t j = 0; j < 37; j++) {
+                                        if (chosen[j])
+                                                continue;
+                                        if (best == 37 || itty_bit_string_evaluate_similarity (queries->bit_strings[i], keys->bit_strings[j]) >
+                                                          itty_bit_string_evaluate_similarity (queries->bit_strings[i], keys->bit_strings[best]))
+                                                best = j;
+                                }
+                                chosen[best] = true;
+
+                                for (size_t bit = 0; bit < values->bit_strings[best]->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS; bit++)
+                                        counts[bit] += (values->bit_strings[best]->words[bit / ITTY_BIT_STRING_WORD_SIZE_IN_BITS] >> (bit % ITTY_BIT_STRING_WORD_SIZE_IN_BITS)) & 1;
+                        }
+
+                        assert (result->number_of_words == 3);
+                        for (size_t bit = 0; bit < 3 * ITTY_BIT_STRING_WORD_SIZE_IN_BITS; bit++)
+                                assert (((result->words[bit / ITTY_BIT_STRING_WORD_SIZE_IN_BITS] >> (bit % ITTY_BIT_STRING_WORD_SIZE_IN_BITS)) & 1) == (counts[bit] > k / 2));
+                }
+
+                itty_bit_string_list_free (attended);
+        }
+
+        itty_bit_string_list_t *short_values = new_mixed_width_list (36, 3);
+        assert (itty_bit_string_list_attend (queries, keys, short_values, 1) == NULL);
+        itty_bit_string_list_free (short_values);
+
+        itty_bit_string_list_free (queries);
+        itty_bit_string_list_free (keys);
+        itty_bit_string_list_free (values);
+}
+
+void
+test_itty_bit_string_list_with_manager (void)
+{
+        itty_bit_string_list_t *list_a = new_wide_list (200, 1000, 1);
+        itty_bit_string_list_t *list_b = new_wide_list (190, 1000, 2);
+        itty_manager_t *manager = itty_manager_new ();
+
+        itty_bit_string_list_t *exclusive_or = itty_bit_string_list_exclusive_or (list_a, list_b);
+        itty_bit_string_list_t *parallel_exclusive_or = itty_bit_string_list_exclusive_or_with_manager (list_a, list_b, manager);
+        assert (itty_bit_string_list_get_length (parallel_exclusive_or) == 190);
+        for (size_t i = 0; i < 190; i++)
+                assert (itty_bit_string_equal (exclusive_or->bit_strings[i], parallel_exclusive_or->bit_strings[i]));
+        itty_bit_string_list_free (parallel_exclusive_or);
+        itty_bit_string_list_free (exclusive_or);
+
+        itty_bit_string_t *condensed = itty_bit_string_list_condense (list_a);
+        itty_bit_string_t *parallel_condensed = itty_bit_string_list_condense_with_manager (list_a, manager);
+        assert (itty_bit_string_equal (condensed, parallel_condensed));
+        itty_bit_string_free (parallel_condensed);
+        itty_bit_string_free (condensed);
+
+        itty_bit_string_list_t *transposed = itty_bit_string_list_transpose (list_b);
+        itty_bit_string_list_t *parallel_transposed = itty_bit_string_list_transpose_with_manager (list_b, manager);
+        assert (itty_bit_string_list_get_length (transposed) == itty_bit_string_list_get_length (parallel_transposed));
+        for (size_t i = 0; i < itty_bit_string_list_get_length (transposed); i++)
+                assert (itty_bit_string_equal (transposed->bit_strings[i], parallel_transposed->bit_strings[i]));
+        itty_bit_string_list_free (parallel_transposed);
+        itty_bit_string_list_free (transposed);
+
+        uint32_t *similarities = malloc (200 * 190 * sizeof (uint32_t));
+        uint32_t *parallel_similarities = malloc (200 * 190 * sizeof (uint32_t));
+        itty_bit_string_list_evaluate_similarities (list_a, list_b, similarities);
+        itty_bit_string_list_evaluate_similarities_with_manager (list_a, list_b, parallel_similarities, manager);
+        assert (memcmp (similarities, parallel_similarities, 200 * 190 * sizeof (uint32_t)) == 0);
+        assert (similarities[7 * 190 + 5] == itty_bit_string_evaluate_similarity (list_a->bit_strings[7], list_b->bit_strings[5]));
+        free (parallel_similarities);
+        free (similarities);
+
+        itty_manager_free (manager);
+        itty_bit_string_list_free (list_a);
+        itty_bit_string_list_free (list_b);
+}
+
+static void
+assert_lists_equal (itty_bit_string_list_t *list_a,
+                    itty_bit_string_list_t *list_b)
+{
+        assert (itty_bit_string_list_get_length (list_a) == itty_bit_string_list_get_length (list_b));
+        for (size_t i = 0; i < itty_bit_string_list_get_length (list_a); i++)
+                assert (itty_bit_string_equal (list_a->bit_strings[i], list_b->bit_strings[i]));
+}
+
+void
+test_itty_bit_string_list_sparse (void)
+{
+        itty_bit_string_list_t *list = itty_bit_string_list_new ();
+        itty_bit_string_list_t *dense_list = itty_bit_string_list_new ();
+
+        for (size_t i = 0; i < 5; i++) {
+                itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+                for (size_t j = 0; j < 128; j++)
+                        itty_bit_string_append_word (bit_string, (i + j) % 40 == 0 ? random_word () : 0);
+
+                itty_bit_string_t *sparse = itty_bit_string_mask (bit_string, bit_string);
+                assert (itty_bit_string_is_sparse (sparse));
+                itty_bit_string_list_append (list, sparse);
+                itty_bit_string_list_append (dense_list, itty_bit_string_copy (sparse));
+                itty_bit_string_free (bit_string);
+        }
+
+        itty_bit_string_t *condensed = itty_bit_string_list_condense (list);
+        itty_bit_string_t *expected_condensed = itty_bit_string_list_condense (dense_list);
+        assert (itty_bit_string_equal (condensed, expected_condensed));
+        itty_bit_string_free (condensed);
+        itty_bit_string_free (expected_condensed);
+
+        itty_bit_string_list_t *transposed = itty_bit_string_list_transpose (list);
+        itty_bit_string_list_t *expected_transposed = itty_bit_string_list_transpose (dense_list);
+        assert_lists_equal (transposed, expected_transposed);
+        itty_bit_string_list_free (transposed);
+        itty_bit_string_list_free (expected_transposed);
+
+        itty_manager_t *manager = itty_manager_new ();
+        itty_bit_string_list_t *exclusive_or = itty_bit_string_list_exclusive_or_with_manager (list, dense_list, manager);
+        itty_bit_string_list_t *expected_exclusive_or = itty_bit_string_list_exclusive_or (dense_list, dense_list);
+        assert_lists_equal (exclusive_or, expected_exclusive_or);
+        itty_bit_string_list_free (exclusive_or);
+        itty_bit_string_list_free (expected_exclusive_or);
+        itty_manager_free (manager);
+
+        uint32_t similarities[5 * 5];
+        uint32_t expected_similarities[5 * 5];
+        itty_bit_string_list_evaluate_similarities (list, dense_list, similarities);
+        itty_bit_string_list_evaluate_similarities (dense_list, dense_list, expected_similarities);
+        assert (memcmp (similarities, expected_similarities, sizeof (similarities)) == 0);
+
+        itty_bit_string_list_t *attended = itty_bit_string_list_attend (list, list, list, 3);
+        itty_bit_string_list_t *expected_attended = itty_bit_string_list_attend (dense_list, dense_list, dense_list, 3);
+        assert_lists_equal (attended, expected_attended);
+        itty_bit_string_list_free (attended);
+        itty_bit_string_list_free (expected_attended);
+
+        for (size_t i = 0; i < 5; i++)
+                assert (itty_bit_string_is_sparse (list->bit_strings[i]));
+
+        itty_bit_string_list_free (list);
+        itty_bit_string_list_free (dense_list);
+}
+
 int
 main (void)
 {
@@ -144,8 +651,18 @@ main (void)
         test_itty_bit_string_list_append ();
         test_itty_bit_string_list_exclusive_or ();
         test_itty_bit_string_list_transpose ();
+        test_itty_bit_string_list_transpose_tiles ();
         test_itty_bit_string_list_condense ();
+        test_itty_bit_string_list_condense_with_threshold ();
         test_itty_bit_string_list_sort ();
+        test_itty_bit_string_list_get_sorted_indices ();
+        test_itty_bit_string_list_pop_count_argmax ();
+        test_itty_bit_string_list_present ();
+        test_itty_bit_string_list_get_pop_counts ();
+        test_itty_bit_string_list_evaluate_similarities ();
+        test_itty_bit_string_list_attend ();
+        test_itty_bit_string_list_with_manager ();
+        test_itty_bit_string_list_sparse ();
 
         printf ("All itty-bit-string-list tests passed.\n");
         return 0;
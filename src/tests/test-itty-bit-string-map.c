@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "itty-bit-string.h"
@@ -46,6 +47,108 @@ test_itty_bit_string_map_file_next (void)
         remove (file_name);
 }
 
+void
+test_itty_bit_string_map_file_next_writable (void)
+{
+        const char *file_name = "testfile.bin";
+        FILE *file = fopen (file_name, "w");
+        size_t words[4] = { 1, 2, 3, 4 };
+
+        fwrite (words, sizeof (size_t), 4, file);
+        fclose (file);
+
+        itty_bit_string_map_file_t *mapped_file = itty_bit_string_map_file_new (file_name);
+        assert (mapped_file != NULL);
+
+        itty_bit_string_t *first = itty_bit_string_map_file_next (mapped_file, 2);
+        itty_bit_string_t *second = itty_bit_string_map_file_next (mapped_file, 2);
+        size_t *mapped_words = (size_t *) itty_bit_string_map_file_get_mapped_data (mapped_file);
+
+        itty_bit_string_exclusive_or_into (first, first, second);
+        assert (first->words[0] == 2 && first->words[1] == 6);
+
+        itty_bit_string_append_word (second, 5);
+        assert (second->number_of_words == 3 && second->words[2] == 5);
+
+        assert (mapped_words[0] == 1 && mapped_words[1] == 2);
+        assert (mapped_words[2] == 3 && mapped_words[3] == 4);
+
+        itty_bit_string_free (first);
+        itty_bit_string_free (second);
+        itty_bit_string_map_file_free (mapped_file);
+        remove (file_name);
+}
+
+void
+test_itty_bit_string_map_file_next_aligned (void)
+{
+        const char *file_name = "testfile.bin";
+        FILE *file = fopen (file_name, "w");
+        size_t words[24] = { 0 };
+
+        words[0] = 1;
+        words[8] = 2;
+        words[9] = 3;
+        words[10] = 4;
+        words[16] = 5;
+        fwrite (words, sizeof (size_t), 24, file);
+        fclose (file);
+
+        itty_bit_string_map_file_t *mapped_file = itty_bit_string_map_file_new (file_name);
+        assert (mapped_file != NULL);
+
+        itty_bit_string_t *first = itty_bit_string_map_file_next_aligned (mapped_file, 1);
+        itty_bit_string_t *second = itty_bit_string_map_file_next_aligned (mapped_file, 3);
+        itty_bit_string_t *third = itty_bit_string_map_file_next_aligned (mapped_file, 8);
+        assert (itty_bit_string_map_file_next_aligned (mapped_file, 1) == NULL);
+
+        assert (itty_bit_string_is_aligned (first));
+        assert (((uintptr_t) first->words % ITTY_BIT_STRING_ALIGNMENT) == 0);
+        assert (((uintptr_t) second->words % ITTY_BIT_STRING_ALIGNMENT) == 0);
+        assert (((uintptr_t) third->words % ITTY_BIT_STRING_ALIGNMENT) == 0);
+        assert (first->words[0] == 1);
+        assert (second->number_of_words == 3);
+        assert (second->words[0] == 2 && second->words[2] == 4);
+        assert (third->words[0] == 5);
+
+        itty_bit_string_free (first);
+        itty_bit_string_free (second);
+        itty_bit_string_free (third);
+        itty_bit_string_map_file_free (mapped_file);
+        remove (file_name);
+}
+
+void
+test_itty_bit_string_map_file_next_matrix (void)
+{
+        const char *file_name = "testfile.bin";
+        FILE *file = fopen (file_name, "w");
+        size_t words[7] = { 1, 2, 3, 4, 5, 6, 7 };
+
+        fwrite (words, sizeof (size_t), 7, file);
+        fclose (file);
+
+        itty_bit_string_map_file_t *mapped_file = itty_bit_string_map_file_new (file_name);
+        assert (mapped_file != NULL);
+
+        itty_bit_matrix_t *matrix = itty_bit_string_map_file_next_matrix (mapped_file, 3, 2);
+        assert (matrix != NULL);
+        assert (itty_bit_matrix_get_number_of_rows (matrix) == 3);
+        assert (itty_bit_matrix_get_number_of_words (matrix) == 2);
+        assert (itty_bit_matrix_get_row_words (matrix, 0) == (size_t *) itty_bit_string_map_file_get_mapped_data (mapped_file));
+        assert (itty_bit_matrix_get_row_words (matrix, 2)[1] == 6);
+
+        assert (itty_bit_string_map_file_next_matrix (mapped_file, 2, 1) == NULL);
+        itty_bit_matrix_t *last = itty_bit_string_map_file_next_matrix (mapped_file, 1, 1);
+        assert (last != NULL);
+        assert (itty_bit_matrix_get_row_words (last, 0)[0] == 7);
+
+        itty_bit_matrix_free (matrix);
+        itty_bit_matrix_free (last);
+        itty_bit_string_map_file_free (mapped_file);
+        remove (file_name);
+}
+
 void
 test_itty_bit_string_map_file_resize (void)
 {
@@ -71,6 +174,9 @@ main (void)
 {
         test_itty_bit_string_map_file_new_and_free ();
         test_itty_bit_string_map_file_next ();
+        test_itty_bit_string_map_file_next_writable ();
+        test_itty_bit_string_map_file_next_aligned ();
+        test_itty_bit_string_map_file_next_matrix ();
         test_itty_bit_string_map_file_resize ();
 
         printf ("All itty-bit-string-map tests passed.\n");
@@ -0,0 +1,180 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "itty-bit-string.h"
+#include "itty-bit-string-private.h"
+#include "itty-bit-string-sparse-private.h"
+#include "test-itty-random.h"
+
+#define NUMBER_OF_WORDS (3 * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER - 100)
+
+/* Scattered bits, then long runs, then a partial container of random words */
+static void
+fill_words (size_t *words,
+            size_t  seed)
+{
+        srand (seed);
+        memset (words, 0, NUMBER_OF_WORDS * sizeof (size_t));
+
+        for (size_t i = 0; i < 500; i++) {
+                size_t position = rand () % ITTY_BIT_STRING_SPARSE_BITS_PER_CONTAINER;
+                words[position / ITTY_BIT_STRING_WORD_SIZE_IN_BITS] |= 1UL << (position % ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+        }
+
+        for (size_t i = 0; i < 20; i++) {
+                size_t start = ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER + rand () % (ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER - 40);
+                size_t length = rand () % 40;
+
+                for (size_t j = 0; j < length; j++)
+                        words[start + j] = ~0UL;
+                words[start + length] = ~0UL >> (seed % ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+        }
+
+        for (size_t i = 2 * ITTY_BIT_STRING_SPARSE_WORDS_PER_CONTAINER; i < NUMBER_OF_WORDS; i++)
+                words[i] = random_word ();
+}
+
+static size_t
+count_bits (const size_t *words,
+            size_t        number_of_words)
+{
+        size_t count = 0;
+
+        for (size_t i = 0; i < number_of_words; i++)
+                count += __builtin_popcountl (words[i]);
+
+        return count;
+}
+
+void
+test_itty_bit_string_sparse_new_from_words (void)
+{
+        size_t *words = malloc (NUMBER_OF_WORDS * sizeof (size_t));
+        size_t *round_trip = malloc (NUMBER_OF_WORDS * sizeof (size_t));
+
+        fill_words (words, 1);
+
+        itty_bit_string_sparse_t *sparse = itty_bit_string_sparse_new_from_words (NULL, words, NUMBER_OF_WORDS);
+        assert (sparse->number_of_containers == 3);
+        assert (sparse->cardinality == count_bits (words, NUMBER_OF_WORDS));
+        assert (sparse->containers[0].type == ITTY_BIT_STRING_CONTAINER_TYPE_ARRAY);
+        assert (sparse->containers[1].type == ITTY_BIT_STRING_CONTAINER_TYPE_RUN);
+        assert (sparse->containers[2].type == ITTY_BIT_STRING_CONTAINER_TYPE_BITMAP);
+
+        itty_bit_string_sparse_get_words (sparse, round_trip, NUMBER_OF_WORDS);
+        assert (memcmp (words, round_trip, NUMBER_OF_WORDS * sizeof (size_t)) == 0);
+        for (size_t i = 0; i < NUMBER_OF_WORDS; i++)
+                assert (itty_bit_string_sparse_get_word (sparse, i) == words[i]);
+        itty_bit_string_sparse_free (sparse);
+
+        memset (words, 0, NUMBER_OF_WORDS * sizeof (size_t));
+        words[NUMBER_OF_WORDS - 1] = 1UL << 63;
+        sparse = itty_bit_string_sparse_new_from_words (NULL, words, NUMBER_OF_WORDS);
+        assert (sparse->number_of_containers == 1);
+        assert (sparse->containers[0].key == 2);
+        assert (sparse->cardinality == 1);
+        assert (itty_bit_string_sparse_get_word (sparse, 0) == 0);
+        assert (itty_bit_string_sparse_get_word (sparse, NUMBER_OF_WORDS - 1) == 1UL << 63);
+        itty_bit_string_sparse_free (sparse);
+
+        free (words);
+        free (round_trip);
+}
+
+void
+test_itty_bit_string_sparse_operations (void)
+{
+        size_t *a_words = malloc (NUMBER_OF_WORDS * sizeof (size_t));
+        size_t *b_words = malloc (NUMBER_OF_WORDS * sizeof (size_t));
+        size_t *expected = malloc (NUMBER_OF_WORDS * sizeof (size_t));
+        size_t *result_words = malloc (NUMBER_OF_WORDS * sizeof (size_t));
+
+        fill_words (a_words, 2);
+        fill_words (b_words, 3);
+
+        itty_bit_string_sparse_t *a = itty_bit_string_sparse_new_from_words (NULL, a_words, NUMBER_OF_WORDS);
+        itty_bit_string_sparse_t *b = itty_bit_string_sparse_new_from_words (NULL, b_words, NUMBER_OF_WORDS);
+
+        for (size_t i = 0; i < NUMBER_OF_WORDS; i++)
+                expected[i] = a_words[i] & b_words[i];
+        itty_bit_string_sparse_t *result = itty_bit_string_sparse_mask (NULL, a, b);
+        itty_bit_string_sparse_get_words (result, result_words, NUMBER_OF_WORDS);
+        assert (memcmp (expected, result_words, NUMBER_OF_WORDS * sizeof (size_t)) == 0);
+        assert (result->cardinality == count_bits (expected, NUMBER_OF_WORDS));
+        assert (itty_bit_string_sparse_evaluate_overlap (a, b) == result->cardinality);
+        assert (itty_bit_string_sparse_evaluate_overlap_with_words (a, b_words, NUMBER_OF_WORDS) == result->cardinality);
+        itty_bit_string_sparse_free (result);
+
+        result = itty_bit_string_sparse_mask_words (NULL, a, b_words, NUMBER_OF_WORDS);
+        itty_bit_string_sparse_get_words (result, result_words, NUMBER_OF_WORDS);
+        assert (memcmp (expected, result_words, NUMBER_OF_WORDS * sizeof (size_t)) == 0);
+        itty_bit_string_sparse_free (result);
+
+        for (size_t i = 0; i < NUMBER_OF_WORDS; i++)
+                expected[i] = a_words[i] | b_words[i];
+        result = itty_bit_string_sparse_combine (NULL, a, b);
+        itty_bit_string_sparse_get_words (result, result_words, NUMBER_OF_WORDS);
+        assert (memcmp (expected, result_words, NUMBER_OF_WORDS * sizeof (size_t)) == 0);
+        itty_bit_string_sparse_free (result);
+
+        memcpy (result_words, b_words, NUMBER_OF_WORDS * sizeof (size_t));
+        itty_bit_string_sparse_combine_into_words (a, result_words, NUMBER_OF_WORDS);
+        assert (memcmp (expected, result_words, NUMBER_OF_WORDS * sizeof (size_t)) == 0);
+
+        for (size_t i = 0; i < NUMBER_OF_WORDS; i++)
+                expected[i] = a_words[i] ^ b_words[i];
+        result = itty_bit_string_sparse_exclusive_or (NULL, a, b);
+        itty_bit_string_sparse_get_words (result, result_words, NUMBER_OF_WORDS);
+        assert (memcmp (expected, result_words, NUMBER_OF_WORDS * sizeof (size_t)) == 0);
+        itty_bit_string_sparse_free (result);
+
+        memcpy (result_words, b_words, NUMBER_OF_WORDS * sizeof (size_t));
+        itty_bit_string_sparse_exclusive_or_into_words (a, result_words, NUMBER_OF_WORDS);
+        assert (memcmp (expected, result_words, NUMBER_OF_WORDS * sizeof (size_t)) == 0);
+
+        result = itty_bit_string_sparse_exclusive_or (NULL, a, a);
+        assert (result->number_of_containers == 0);
+        assert (result->cardinality == 0);
+        itty_bit_string_sparse_free (result);
+
+        itty_bit_string_sparse_free (a);
+        itty_bit_string_sparse_free (b);
+        free (a_words);
+        free (b_words);
+        free (expected);
+        free (result_words);
+}
+
+void
+test_itty_bit_string_sparse_arena (void)
+{
+        size_t *words = malloc (NUMBER_OF_WORDS * sizeof (size_t));
+        size_t *round_trip = malloc (NUMBER_OF_WORDS * sizeof (size_t));
+        itty_arena_t *arena = itty_arena_new ();
+
+        fill_words (words, 4);
+
+        itty_bit_string_sparse_t *sparse = itty_bit_string_sparse_new_from_words (arena, words, NUMBER_OF_WORDS);
+        itty_bit_string_sparse_t *doubled = itty_bit_string_sparse_combine (arena, sparse, sparse);
+        assert (doubled->arena == arena);
+        itty_bit_string_sparse_get_words (doubled, round_trip, NUMBER_OF_WORDS);
+        assert (memcmp (words, round_trip, NUMBER_OF_WORDS * sizeof (size_t)) == 0);
+        itty_bit_string_sparse_free (doubled);
+        itty_bit_string_sparse_free (sparse);
+
+        itty_arena_free (arena);
+        free (words);
+        free (round_trip);
+}
+
+int
+main (void)
+{
+        test_itty_bit_string_sparse_new_from_words ();
+        test_itty_bit_string_sparse_operations ();
+        test_itty_bit_string_sparse_arena ();
+
+        printf ("All itty-bit-string-sparse tests passed.\n");
+        return 0;
+}
@@ -1,9 +1,14 @@
 #include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "itty-bit-string.h"
 #include "itty-bit-string-private.h"
+#include "itty-bit-string-list.h"
+#include "itty-bit-string-list-private.h"
+#include "test-itty-random.h"
 
 void
 test_itty_bit_string_new (void)
@@ -29,6 +34,77 @@ test_itty_bit_string_append_word (void)
         itty_bit_string_free (bit_string);
 }
 
+void
+test_itty_bit_string_inline_words (void)
+{
+        itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+        for (size_t i = 0; i < ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS; i++) {
+                itty_bit_string_append_word (bit_string, i + 1);
+                assert (bit_string->words == bit_string->inline_words);
+        }
+
+        itty_bit_string_append_word (bit_string, ~0UL);
+        assert (bit_string->words != bit_string->inline_words);
+        assert (bit_string->number_of_words == ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS + 1);
+        for (size_t i = 0; i < ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS; i++) {
+                assert (bit_string->words[i] == i + 1);
+        }
+        assert (bit_string->words[ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS] == ~0UL);
+        itty_bit_string_free (bit_string);
+
+        size_t mapped_words[] = { 0b1100, 0b1010 };
+        itty_bit_string_t *copy_on_write = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_COPY_ON_WRITE);
+        copy_on_write->words = mapped_words;
+        copy_on_write->number_of_words = 2;
+        itty_bit_string_append_word (copy_on_write, 0b0110);
+        assert (copy_on_write->words == copy_on_write->inline_words);
+        assert (copy_on_write->mutability == ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        assert (copy_on_write->words[0] == 0b1100);
+        assert (copy_on_write->words[1] == 0b1010);
+        assert (copy_on_write->words[2] == 0b0110);
+        assert (mapped_words[0] == 0b1100 && mapped_words[1] == 0b1010);
+        itty_bit_string_free (copy_on_write);
+}
+
+void
+test_itty_bit_string_reserve (void)
+{
+        itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_reserve (bit_string, 100);
+        assert (bit_string->capacity == 100);
+        assert (bit_string->number_of_words == 0);
+
+        size_t *words = bit_string->words;
+        for (size_t i = 0; i < 100; i++) {
+                itty_bit_string_append_word (bit_string, i);
+        }
+        assert (bit_string->words == words);
+        assert (bit_string->capacity == 100);
+
+        itty_bit_string_append_word (bit_string, 100);
+        assert (bit_string->capacity == 200);
+        for (size_t i = 0; i <= 100; i++) {
+                assert (bit_string->words[i] == i);
+        }
+
+        itty_bit_string_reserve (bit_string, 10);
+        assert (bit_string->capacity == 200);
+        itty_bit_string_free (bit_string);
+
+        bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        for (size_t i = 0; i < ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS + 1; i++) {
+                itty_bit_string_append_word (bit_string, i);
+        }
+        assert (bit_string->capacity == 2 * ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS);
+        itty_bit_string_append_zeros (bit_string, 1000);
+        assert (bit_string->number_of_words == ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS + 1001);
+        assert (bit_string->capacity >= bit_string->number_of_words);
+        assert (bit_string->words[ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS] == ITTY_BIT_STRING_NUMBER_OF_INLINE_WORDS);
+        assert (itty_bit_string_get_pop_count (bit_string) == 5);
+        itty_bit_string_free (bit_string);
+}
+
 void
 test_itty_bit_string_append_zeros (void)
 {
@@ -98,6 +174,61 @@ test_itty_bit_string_combine (void)
         itty_bit_string_free (result);
 }
 
+void
+test_itty_bit_string_exclusive_or_into (void)
+{
+        itty_bit_string_t *a = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_t *b = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_append_word (a, 0b1100);
+        itty_bit_string_append_word (a, 0b0011);
+        itty_bit_string_append_word (b, 0b1010);
+        itty_bit_string_append_zeros (result, 2);
+        size_t *words = result->words;
+
+        itty_bit_string_exclusive_or_into (result, a, b);
+        assert (result->words == words);
+        assert (result->number_of_words == 2);
+        assert (result->words[0] == 0b0110);
+        assert (result->words[1] == 0b0011);
+
+        itty_bit_string_exclusive_nor_into (result, a, b);
+        assert (result->words[0] == ~0b0110UL);
+        assert (result->words[1] == ~0b0011UL);
+
+        itty_bit_string_combine_into (result, a, b);
+        assert (result->words[0] == 0b1110);
+        assert (result->words[1] == 0b0011);
+
+        itty_bit_string_mask_into (result, a, b);
+        assert (result->words == words);
+        assert (result->words[0] == 0b1000);
+        assert (result->words[1] == 0);
+
+        itty_bit_string_free (a);
+        itty_bit_string_free (b);
+        itty_bit_string_free (result);
+}
+
+void
+test_itty_bit_string_exclusive_or_in_place (void)
+{
+        itty_bit_string_t *a = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_t *b = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_append_word (a, 0b1100);
+        itty_bit_string_append_word (b, 0b1010);
+        itty_bit_string_append_word (b, 0b0001);
+
+        itty_bit_string_exclusive_or_into (a, a, b);
+        assert (a->number_of_words == 2);
+        assert (a->words[0] == 0b0110);
+        assert (a->words[1] == 0b0001);
+        assert (itty_bit_string_get_pop_count (a) == 3);
+
+        itty_bit_string_free (a);
+        itty_bit_string_free (b);
+}
+
 void
 test_itty_bit_string_get_pop_count (void)
 {
@@ -121,6 +252,28 @@ test_itty_bit_string_evaluate_similarity (void)
         itty_bit_string_free (b);
 }
 
+void
+test_itty_bit_string_evaluate_distance_and_overlap (void)
+{
+        itty_bit_string_t *a = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_t *b = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_append_word (a, 0b1100);
+        itty_bit_string_append_word (a, 0b0111);
+        itty_bit_string_append_word (b, 0b1010);
+
+        assert (itty_bit_string_evaluate_distance (a, b) == 5);
+        assert (itty_bit_string_evaluate_distance (b, a) == 5);
+        assert (itty_bit_string_evaluate_overlap (a, b) == 1);
+        assert (itty_bit_string_evaluate_similarity (a, b) == 2 * ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 5);
+
+        itty_bit_string_t *exclusive_nor_result = itty_bit_string_exclusive_nor (b, a);
+        assert (itty_bit_string_evaluate_similarity (b, a) == itty_bit_string_get_pop_count (exclusive_nor_result));
+        itty_bit_string_free (exclusive_nor_result);
+
+        itty_bit_string_free (a);
+        itty_bit_string_free (b);
+}
+
 void
 test_itty_bit_string_compare_by_pop_count (void)
 {
@@ -133,6 +286,8 @@ test_itty_bit_string_compare_by_pop_count (void)
         itty_bit_string_append_word (a, 0b1111);
         cmp = itty_bit_string_compare_by_pop_count (a, b);
         assert (cmp > 0);
+        cmp = itty_bit_string_compare_by_pop_count (b, a);
+        assert (cmp < 0);
         itty_bit_string_free (a);
         itty_bit_string_free (b);
 }
@@ -165,10 +320,504 @@ test_itty_bit_string_reduce_by_half (void)
         char expected[] = "0000000000000000000000000000000000000000000000000000000000001100";
         assert (strcmp (representation, expected) == 0);
         free (representation);
+        itty_bit_string_append_word (bit_string, 0b1100);
+        assert (bit_string->number_of_words == 3);
         itty_bit_string_free (bit_string);
         itty_bit_string_free (reduced);
 }
 
+void
+test_itty_bit_string_new_view (void)
+{
+        itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        for (size_t i = 0; i < 8; i++) {
+                itty_bit_string_append_word (bit_string, i + 1);
+        }
+
+        itty_bit_string_t *view = itty_bit_string_new_view (bit_string, 2, 4);
+        itty_bit_string_t *storage = view->parent;
+        assert (view->words == bit_string->words + 2);
+        assert (view->number_of_words == 4);
+        assert (view->mutability == ITTY_BIT_STRING_MUTABILITY_COPY_ON_WRITE);
+        assert (storage != bit_string && bit_string->parent == storage);
+        assert (bit_string->mutability == ITTY_BIT_STRING_MUTABILITY_COPY_ON_WRITE);
+        assert (atomic_load (&bit_string->reference_count) == 1);
+        assert (atomic_load (&storage->reference_count) == 2);
+
+        itty_bit_string_t *nested_view = itty_bit_string_new_view (view, 1, 2);
+        assert (nested_view->words == bit_string->words + 3);
+        assert (nested_view->parent == storage);
+        assert (atomic_load (&storage->reference_count) == 3);
+
+        /* Writing to the string copies it away from its views */
+        itty_bit_string_append_word (bit_string, 9);
+        assert (bit_string->parent == NULL);
+        assert (bit_string->words[2] == 3 && bit_string->words[8] == 9);
+        assert (atomic_load (&storage->reference_count) == 2);
+        assert (view->words == storage->words + 2);
+
+        /* The storage outlives the string for as long as views remain */
+        itty_bit_string_free (bit_string);
+        assert (view->words[0] == 3);
+        assert (nested_view->words[1] == 5);
+
+        /* Writing to a view detaches it from the parent */
+        itty_bit_string_append_word (view, 9);
+        assert (view->parent == NULL);
+        assert (view->mutability == ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        assert (view->number_of_words == 5);
+        assert (view->words[0] == 3 && view->words[3] == 6 && view->words[4] == 9);
+        assert (nested_view->words[0] == 4);
+
+        itty_bit_string_free (nested_view);
+        itty_bit_string_free (view);
+}
+
+static void *
+unref_bit_string (void *data)
+{
+        itty_bit_string_unref (data);
+        return NULL;
+}
+
+void
+test_itty_bit_string_ref (void)
+{
+        itty_bit_string_t *mask = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        for (size_t i = 0; i < 8; i++) {
+                itty_bit_string_append_word (mask, ~i);
+        }
+
+        itty_bit_string_list_t *list_a = itty_bit_string_list_new ();
+        itty_bit_string_list_t *list_b = itty_bit_string_list_new ();
+        itty_bit_string_list_append (list_a, itty_bit_string_ref (mask));
+        itty_bit_string_list_append (list_b, itty_bit_string_ref (mask));
+        assert (list_a->bit_strings[0] == list_b->bit_strings[0]);
+        assert (atomic_load (&mask->reference_count) == 3);
+
+        itty_bit_string_list_free (list_a);
+        itty_bit_string_unref (mask);
+        assert (atomic_load (&mask->reference_count) == 1);
+        assert (list_b->bit_strings[0]->words[7] == ~7UL);
+        itty_bit_string_list_free (list_b);
+
+        pthread_t threads[8];
+        itty_bit_string_t *shared = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        for (size_t i = 0; i < 16; i++) {
+                itty_bit_string_append_word (shared, i);
+        }
+        for (size_t i = 1; i < 8; i++) {
+                itty_bit_string_ref (shared);
+        }
+        for (size_t i = 0; i < 8; i++) {
+                pthread_create (&threads[i], NULL, unref_bit_string, shared);
+        }
+        for (size_t i = 0; i < 8; i++) {
+                pthread_join (threads[i], NULL);
+        }
+}
+
+void
+test_itty_bit_string_split (void)
+{
+        itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        for (size_t i = 0; i < 5; i++) {
+                itty_bit_string_append_word (bit_string, i + 1);
+        }
+
+        itty_bit_string_list_t *list = itty_bit_string_split (bit_string, 3);
+        assert (list->count == 3);
+        assert (list->bit_strings[0]->words == bit_string->words);
+        assert (list->bit_strings[1]->words == bit_string->words + 2);
+        assert (list->bit_strings[2]->parent == NULL);
+        assert (list->bit_strings[2]->number_of_words == 2);
+        assert (list->bit_strings[2]->words[0] == 5);
+        assert (list->bit_strings[2]->words[1] == 0);
+
+        itty_bit_string_append_word (bit_string, 6);
+        itty_bit_string_exclusive_or_into (bit_string, bit_string, bit_string);
+        assert (itty_bit_string_get_pop_count (bit_string) == 0);
+        assert (itty_bit_string_get_pop_count (list->bit_strings[1]) == 3);
+
+        itty_bit_string_free (bit_string);
+        assert (list->bit_strings[1]->words[1] == 4);
+        itty_bit_string_list_free (list);
+}
+
+static bool
+get_bit_from_top (itty_bit_string_t *bit_string,
+                  size_t             position)
+{
+        size_t word = bit_string->words[position / ITTY_BIT_STRING_WORD_SIZE_IN_BITS];
+        return (word >> (ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1 - position % ITTY_BIT_STRING_WORD_SIZE_IN_BITS)) & 1;
+}
+
+static itty_bit_string_t *
+new_random_bit_string (size_t number_of_words)
+{
+        itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        for (size_t i = 0; i < number_of_words; i++) {
+                itty_bit_string_append_word (bit_string, random_word ());
+        }
+        return bit_string;
+}
+
+void
+test_itty_bit_string_get_hash (void)
+{
+        itty_bit_string_t *zero = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_append_word (zero, 0);
+        assert (itty_bit_string_get_hash (zero) == 0x34c96acdcadb1bbbULL);
+        itty_bit_string_free (zero);
+
+        itty_bit_string_t *a = new_random_bit_string (9);
+        itty_bit_string_t *b = itty_bit_string_copy (a);
+        uint64_t hash = itty_bit_string_get_hash (a);
+        assert (a->hash_computed);
+        assert (itty_bit_string_get_hash (b) == hash);
+        assert (itty_bit_string_equal (a, b));
+
+        b->words[8] ^= 1;
+        b->hash_computed = false;
+        assert (itty_bit_string_get_hash (b) != hash);
+        assert (!itty_bit_string_equal (a, b));
+
+        itty_bit_string_append_word (a, 0);
+        assert (!a->hash_computed);
+        assert (itty_bit_string_get_hash (a) != hash);
+
+        itty_bit_string_t *view = itty_bit_string_new_view (b, 0, 9);
+        assert (itty_bit_string_get_hash (view) == itty_bit_string_get_hash (b));
+        itty_bit_string_free (view);
+
+        itty_bit_string_free (a);
+        itty_bit_string_free (b);
+}
+
+void
+test_itty_bit_string_aligned (void)
+{
+        itty_bit_string_t *bit_string = itty_bit_string_new_aligned (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_append_word (bit_string, 1);
+        assert (itty_bit_string_is_aligned (bit_string));
+        assert (bit_string->words != bit_string->inline_words);
+        assert (((uintptr_t) bit_string->words % ITTY_BIT_STRING_ALIGNMENT) == 0);
+        assert (bit_string->capacity == ITTY_BIT_STRING_WORDS_PER_ALIGNMENT);
+        for (size_t i = 1; i < ITTY_BIT_STRING_WORDS_PER_ALIGNMENT; i++)
+                assert (bit_string->words[i] == 0);
+
+        itty_bit_string_append_zeros (bit_string, ITTY_BIT_STRING_WORDS_PER_ALIGNMENT + 2);
+        assert (((uintptr_t) bit_string->words % ITTY_BIT_STRING_ALIGNMENT) == 0);
+        assert (bit_string->capacity % ITTY_BIT_STRING_WORDS_PER_ALIGNMENT == 0);
+        assert (bit_string->words[0] == 1);
+        itty_bit_string_free (bit_string);
+
+        for (size_t number_of_words = 1; number_of_words <= 17; number_of_words += 3) {
+                itty_bit_string_t *a = new_random_bit_string (number_of_words);
+                itty_bit_string_t *b = new_random_bit_string (number_of_words);
+                itty_bit_string_t *aligned_a = itty_bit_string_new_aligned (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+                itty_bit_string_t *aligned_b = itty_bit_string_new_aligned (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+                for (size_t i = 0; i < number_of_words; i++) {
+                        itty_bit_string_append_word (aligned_a, a->words[i]);
+                        itty_bit_string_append_word (aligned_b, b->words[i]);
+                }
+
+                itty_bit_string_t *expected = itty_bit_string_exclusive_nor (a, b);
+                itty_bit_string_t *result = itty_bit_string_exclusive_nor (aligned_a, aligned_b);
+                assert (itty_bit_string_is_aligned (result));
+                assert (((uintptr_t) result->words % ITTY_BIT_STRING_ALIGNMENT) == 0);
+                assert (itty_bit_string_compare (result, expected) == 0);
+                assert (itty_bit_string_get_pop_count (result) == itty_bit_string_get_pop_count (expected));
+                itty_bit_string_free (expected);
+                itty_bit_string_free (result);
+
+                expected = itty_bit_string_mask (a, b);
+                itty_bit_string_mask_into (aligned_a, aligned_a, aligned_b);
+                assert (itty_bit_string_compare (aligned_a, expected) == 0);
+                itty_bit_string_free (expected);
+
+                itty_bit_string_free (a);
+                itty_bit_string_free (b);
+                itty_bit_string_free (aligned_a);
+                itty_bit_string_free (aligned_b);
+        }
+}
+
+void
+test_itty_bit_string_sparse (void)
+{
+        size_t number_of_words = 2 * 1024 + 7;
+        itty_bit_string_t *a = new_random_bit_string (number_of_words);
+        itty_bit_string_t *b = new_random_bit_string (number_of_words);
+        itty_bit_string_t *c = new_random_bit_string (number_of_words);
+
+        for (size_t i = 0; i < number_of_words; i++) {
+                if (i % 100 != 0)
+                        a->words[i] = 0;
+                if (i % 70 != 0)
+                        b->words[i] = 0;
+        }
+        a->pop_count_computed = false;
+        b->pop_count_computed = false;
+
+        itty_bit_string_t *masked = itty_bit_string_mask (a, c);
+        itty_bit_string_t *other = itty_bit_string_exclusive_or (a, b);
+        assert (!itty_bit_string_is_sparse (a));
+        assert (itty_bit_string_is_sparse (masked));
+        assert (itty_bit_string_is_sparse (other));
+        assert (masked->words == NULL);
+        assert (itty_bit_string_get_number_of_words (masked) == number_of_words);
+
+        itty_bit_string_t *expected_masked = itty_bit_string_copy (masked);
+        itty_bit_string_t *expected_other = itty_bit_string_copy (other);
+        assert (!itty_bit_string_is_sparse (expected_masked));
+        for (size_t i = 0; i < number_of_words; i++) {
+                assert (expected_masked->words[i] == (a->words[i] & c->words[i]));
+                assert (expected_other->words[i] == (a->words[i] ^ b->words[i]));
+        }
+        assert (itty_bit_string_get_pop_count (masked) == itty_bit_string_get_pop_count (expected_masked));
+
+        assert (itty_bit_string_evaluate_overlap (masked, other) == itty_bit_string_evaluate_overlap (expected_masked, expected_other));
+        assert (itty_bit_string_evaluate_overlap (masked, c) == itty_bit_string_evaluate_overlap (expected_masked, c));
+        assert (itty_bit_string_evaluate_distance (masked, other) == itty_bit_string_evaluate_distance (expected_masked, expected_other));
+        assert (itty_bit_string_evaluate_distance (c, other) == itty_bit_string_evaluate_distance (c, expected_other));
+        assert (itty_bit_string_evaluate_similarity (masked, b) == itty_bit_string_evaluate_similarity (expected_masked, b));
+
+        itty_bit_string_t *result = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_t *expected = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+
+        itty_bit_string_mask_into (result, masked, other);
+        itty_bit_string_mask_into (expected, expected_masked, expected_other);
+        assert (itty_bit_string_is_sparse (result));
+        assert (itty_bit_string_equal (result, expected));
+
+        itty_bit_string_combine_into (result, masked, c);
+        itty_bit_string_combine_into (expected, expected_masked, c);
+        assert (!itty_bit_string_is_sparse (result));
+        assert (itty_bit_string_equal (result, expected));
+
+        itty_bit_string_exclusive_or_into (result, masked, other);
+        itty_bit_string_exclusive_or_into (expected, expected_masked, expected_other);
+        assert (itty_bit_string_get_pop_count (result) == itty_bit_string_get_pop_count (expected));
+        assert (itty_bit_string_equal (result, expected));
+
+        itty_bit_string_exclusive_or_into (masked, masked, c);
+        itty_bit_string_exclusive_or_into (expected_masked, expected_masked, c);
+        assert (!itty_bit_string_is_sparse (masked));
+        assert (itty_bit_string_equal (masked, expected_masked));
+
+        /* Readers leave the string sparse, and sharing it makes it dense */
+        assert (itty_bit_string_get_hash (other) == itty_bit_string_get_hash (expected_other));
+        assert (itty_bit_string_get_length (other) == itty_bit_string_get_length (expected_other));
+        assert (itty_bit_string_compare (other, expected_other) == 0);
+        assert (itty_bit_string_get_presentation_length (other, ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY) ==
+                itty_bit_string_get_presentation_length (expected_other, ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY));
+        char *presentation = itty_bit_string_present (other, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY);
+        char *expected_presentation = itty_bit_string_present (expected_other, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY);
+        assert (strcmp (presentation, expected_presentation) == 0);
+        free (presentation);
+        free (expected_presentation);
+
+        itty_bit_string_iterator_t iterator;
+        size_t word;
+        size_t word_index = 0;
+        itty_bit_string_iterator_init (other, &iterator);
+        while (itty_bit_string_iterator_next (&iterator, &word))
+                assert (word == expected_other->words[word_index++]);
+        assert (word_index == number_of_words);
+
+        itty_bit_string_t *shifted = itty_bit_string_shift_left (other, 67);
+        itty_bit_string_t *expected_shifted = itty_bit_string_shift_left (expected_other, 67);
+        assert (itty_bit_string_equal (shifted, expected_shifted));
+        itty_bit_string_free (shifted);
+        itty_bit_string_free (expected_shifted);
+
+        itty_bit_string_t *doubled = itty_bit_string_double (other);
+        itty_bit_string_t *expected_doubled = itty_bit_string_double (expected_other);
+        assert (itty_bit_string_equal (doubled, expected_doubled));
+        itty_bit_string_free (doubled);
+        itty_bit_string_free (expected_doubled);
+        assert (itty_bit_string_is_sparse (other));
+
+        itty_bit_string_t *shared = itty_bit_string_ref (other);
+        assert (!itty_bit_string_is_sparse (shared));
+        assert (itty_bit_string_equal (shared, expected_other));
+        itty_bit_string_unref (shared);
+
+        itty_bit_string_free (result);
+        itty_bit_string_free (expected);
+        itty_bit_string_free (masked);
+        itty_bit_string_free (other);
+        itty_bit_string_free (expected_masked);
+        itty_bit_string_free (expected_other);
+        itty_bit_string_free (a);
+        itty_bit_string_free (b);
+        itty_bit_string_free (c);
+}
+
+void
+test_itty_bit_string_shift_and_rotate (void)
+{
+        for (size_t number_of_words = 1; number_of_words <= 9; number_of_words += 4) {
+                size_t number_of_bits = number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+                itty_bit_string_t *bit_string = new_random_bit_string (number_of_words);
+
+                for (size_t count = 0; count <= number_of_bits + 1; count += 5) {
+                        itty_bit_string_t *shifted_left = itty_bit_string_shift_left (bit_string, count);
+                        itty_bit_string_t *shifted_right = itty_bit_string_shift_right (bit_string, count);
+                        itty_bit_string_t *rotated_left = itty_bit_string_rotate_left (bit_string, count);
+                        itty_bit_string_t *rotated_right = itty_bit_string_rotate_right (bit_string, count);
+
+                        assert (shifted_left->number_of_words == number_of_words);
+                        assert (rotated_right->number_of_words == number_of_words);
+
+                        for (size_t position = 0; position < number_of_bits; position++) {
+                                bool left = position + count < number_of_bits && get_bit_from_top (bit_string, position + count);
+                                bool right = position >= count && get_bit_from_top (bit_string, position - count);
+                                assert (get_bit_from_top (shifted_left, position) == left);
+                                assert (get_bit_from_top (shifted_right, position) == right);
+                                assert (get_bit_from_top (rotated_left, position) == get_bit_from_top (bit_string, (position + count) % number_of_bits));
+                                assert (get_bit_from_top (rotated_right, (position + count) % number_of_bits) == get_bit_from_top (bit_string, position));
+                        }
+
+                        itty_bit_string_free (shifted_left);
+                        itty_bit_string_free (shifted_right);
+                        itty_bit_string_free (rotated_left);
+                        itty_bit_string_free (rotated_right);
+                }
+
+                itty_bit_string_t *in_place = itty_bit_string_copy (bit_string);
+                itty_bit_string_t *expected = itty_bit_string_rotate_right (bit_string, 70);
+                itty_bit_string_rotate_right_into (in_place, in_place, 70);
+                assert (itty_bit_string_compare (in_place, expected) == 0);
+                itty_bit_string_free (expected);
+
+                expected = itty_bit_string_shift_left (in_place, 3);
+                itty_bit_string_shift_left_into (in_place, in_place, 3);
+                assert (itty_bit_string_compare (in_place, expected) == 0);
+                itty_bit_string_free (expected);
+                itty_bit_string_free (in_place);
+
+                itty_bit_string_free (bit_string);
+        }
+}
+
+void
+test_itty_bit_string_extract_and_concatenate_bits (void)
+{
+        itty_bit_string_t *bit_string = new_random_bit_string (5);
+        size_t number_of_bits = 5 * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+        for (size_t bit_offset = 0; bit_offset < number_of_bits; bit_offset += 13) {
+                for (size_t bit_count = 0; bit_offset + bit_count <= number_of_bits; bit_count += 11) {
+                        itty_bit_string_t *field = itty_bit_string_extract (bit_string, bit_offset, bit_count);
+                        size_t field_number_of_bits = field->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS;
+
+                        assert (field->number_of_words == (bit_count + ITTY_BIT_STRING_WORD_SIZE_IN_BITS - 1) / ITTY_BIT_STRING_WORD_SIZE_IN_BITS);
+                        for (size_t position = 0; position < field_number_of_bits; position++) {
+                                size_t padding = field_number_of_bits - bit_count;
+                                bool expected = position >= padding && get_bit_from_top (bit_string, bit_offset + position - padding);
+                                assert (get_bit_from_top (field, position) == expected);
+                        }
+
+                        itty_bit_string_free (field);
+                }
+        }
+
+        itty_bit_string_t *a = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_t *b = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_append_word (a, 0b101);
+        itty_bit_string_append_word (b, 0b0011);
+        itty_bit_string_t *packed = itty_bit_string_concatenate_bits (a, 3, b, 4);
+        assert (packed->number_of_words == 1);
+        assert (packed->words[0] == 0b1010011);
+        itty_bit_string_free (packed);
+
+        for (size_t a_bit_count = 0; a_bit_count <= number_of_bits; a_bit_count += 29) {
+                for (size_t b_bit_count = 0; b_bit_count <= number_of_bits; b_bit_count += 31) {
+                        itty_bit_string_t *a_field = itty_bit_string_extract (bit_string, number_of_bits - a_bit_count, a_bit_count);
+                        itty_bit_string_t *b_field = itty_bit_string_extract (bit_string, 0, b_bit_count);
+
+                        packed = itty_bit_string_concatenate_bits (bit_string, a_bit_count, b_field, b_bit_count);
+                        itty_bit_string_t *high = itty_bit_string_extract (packed, packed->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS - a_bit_count - b_bit_count, a_bit_count);
+                        itty_bit_string_t *low = itty_bit_string_extract (packed, packed->number_of_words * ITTY_BIT_STRING_WORD_SIZE_IN_BITS - b_bit_count, b_bit_count);
+                        assert (itty_bit_string_get_length (packed) <= a_bit_count + b_bit_count);
+                        assert (itty_bit_string_compare (high, a_field) == 0);
+                        assert (itty_bit_string_compare (low, b_field) == 0);
+
+                        itty_bit_string_free (high);
+                        itty_bit_string_free (low);
+                        itty_bit_string_free (packed);
+                        itty_bit_string_free (a_field);
+                        itty_bit_string_free (b_field);
+                }
+        }
+
+        itty_bit_string_free (a);
+        itty_bit_string_free (b);
+        itty_bit_string_free (bit_string);
+}
+
+void
+test_itty_bit_string_present (void)
+{
+        itty_bit_string_t *bit_string = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_append_word (bit_string, 0);
+        itty_bit_string_append_word (bit_string, 0x1f);
+        itty_bit_string_append_word (bit_string, 0xfedcba9876543210);
+
+        struct {
+                itty_bit_string_presentation_format_t format;
+                const char *expected;
+        } cases[] = {
+                { ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY,
+                  "0000000000000000000000000000000000000000000000000000000000000000"
+                  "0000000000000000000000000000000000000000000000000000000000011111"
+                  "1111111011011100101110101001100001110110010101000011001000010000" },
+                { ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY,
+                  "0b11111"
+                  "1111111011011100101110101001100001110110010101000011001000010000" },
+                { ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL,
+                  "0000000000000000000000000000001ffedcba9876543210" },
+                { ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY,
+                  "0x 1f fedcba9876543210" },
+        };
+
+        for (size_t i = 0; i < sizeof (cases) / sizeof (cases[0]); i++) {
+                size_t expected_length = strlen (cases[i].expected);
+                char *representation = itty_bit_string_present (bit_string, cases[i].format);
+                assert (strcmp (representation, cases[i].expected) == 0);
+                assert (itty_bit_string_get_presentation_length (bit_string, cases[i].format) == expected_length);
+                free (representation);
+
+                char truncated[8];
+                assert (itty_bit_string_present_to_buffer (bit_string, cases[i].format, truncated, sizeof (truncated)) == expected_length);
+                assert (strncmp (truncated, cases[i].expected, sizeof (truncated) - 1) == 0);
+                assert (truncated[sizeof (truncated) - 1] == '\0');
+
+                char *file_contents = NULL;
+                size_t file_size = 0;
+                FILE *file = open_memstream (&file_contents, &file_size);
+                assert (itty_bit_string_present_to_file (bit_string, cases[i].format, file));
+                fclose (file);
+                assert (strcmp (file_contents, cases[i].expected) == 0);
+                free (file_contents);
+        }
+
+        itty_bit_string_t *empty = itty_bit_string_new (ITTY_BIT_STRING_MUTABILITY_READ_WRITE);
+        itty_bit_string_append_zeros (empty, 2);
+        char *representation = itty_bit_string_present (empty, ITTY_BIT_STRING_PRESENTATION_FORMAT_BINARY_FOR_DISPLAY);
+        assert (strcmp (representation, "0b") == 0);
+        free (representation);
+        representation = itty_bit_string_present (empty, ITTY_BIT_STRING_PRESENTATION_FORMAT_HEXADECIMAL_FOR_DISPLAY);
+        assert (strcmp (representation, "0x ") == 0);
+        free (representation);
+
+        itty_bit_string_free (empty);
+        itty_bit_string_free (bit_string);
+}
+
 void
 test_itty_bit_string_get_length (void)
 {
@@ -197,15 +846,29 @@ main (void)
 {
         test_itty_bit_string_new ();
         test_itty_bit_string_append_word ();
+        test_itty_bit_string_inline_words ();
         test_itty_bit_string_append_zeros ();
+        test_itty_bit_string_reserve ();
         test_itty_bit_string_exclusive_nor ();
         test_itty_bit_string_exclusive_or ();
         test_itty_bit_string_combine ();
+        test_itty_bit_string_exclusive_or_into ();
+        test_itty_bit_string_exclusive_or_in_place ();
         test_itty_bit_string_get_pop_count ();
         test_itty_bit_string_evaluate_similarity ();
+        test_itty_bit_string_evaluate_distance_and_overlap ();
+        test_itty_bit_string_get_hash ();
         test_itty_bit_string_compare_by_pop_count ();
         test_itty_bit_string_double ();
         test_itty_bit_string_reduce_by_half ();
+        test_itty_bit_string_new_view ();
+        test_itty_bit_string_ref ();
+        test_itty_bit_string_split ();
+        test_itty_bit_string_aligned ();
+        test_itty_bit_string_sparse ();
+        test_itty_bit_string_shift_and_rotate ();
+        test_itty_bit_string_extract_and_concatenate_bits ();
+        test_itty_bit_string_present ();
 
         printf ("All itty-bit-string tests passed.\n");
         return 0;
@@ -71,10 +71,42 @@ test_itty_manager (void)
         printf ("All tests passed!\n");
 }
 
+static void
+add_one_to_range (void   *data,
+                  size_t  start,
+                  size_t  end)
+{
+        int *items = data;
+
+        for (size_t i = start; i < end; i++) {
+                items[i]++;
+        }
+}
+
+void
+test_itty_manager_run_in_parallel (void)
+{
+        itty_manager_t *manager = itty_manager_new ();
+        size_t number_of_items = 100000;
+        int *items = calloc (number_of_items, sizeof (int));
+
+        itty_manager_run_in_parallel (manager, number_of_items, 1000, add_one_to_range, items);
+        itty_manager_run_in_parallel (manager, number_of_items, number_of_items, add_one_to_range, items);
+        itty_manager_run_in_parallel (manager, 0, 1000, add_one_to_range, items);
+
+        for (size_t i = 0; i < number_of_items; i++) {
+                assert (items[i] == 2);
+        }
+
+        free (items);
+        itty_manager_free (manager);
+}
+
 int
 main (void)
 {
         test_itty_manager ();
+        test_itty_manager_run_in_parallel ();
         return 0;
 }
 
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+
+/* rand () only fills 31 bits, so three calls are mixed to cover a whole word */
+static inline size_t
+random_word (void)
+{
+        return ((size_t) rand () << 33) ^ ((size_t) rand () << 11) ^ (size_t) rand ();
+}